@@ -23,6 +23,7 @@
 #include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -31,6 +32,8 @@ template <typename T>
 using ListType = std::list<T>;
 template <typename K, typename V>
 using MapType = std::map<K, V>;
+template <typename K, typename V>
+using HashMapType = std::unordered_map<K, V>;
 template <typename T>
 using SetType = std::set<T>;
 template <typename T>
@@ -49,6 +52,8 @@ template <typename T>
 using ListType = __gnu_debug::list<T>;
 template <typename K, typename V>
 using MapType = __gnu_debug::map<K, V>;
+template <typename K, typename V>
+using HashMapType = __gnu_debug::map<K, V>;
 template <typename T>
 using SetType = __gnu_debug::set<T>;
 template <typename T>
@@ -261,7 +266,6 @@ struct EquivClass {
   VectorType<StringType> Objects;
   VectorType<Prefix> Prefixes;
 };
-using EquivClassesIterator = ListType<EquivClass>::iterator;
 
 struct FunctionInfo {
   FunctionInfo() = default;
@@ -293,58 +297,126 @@ struct CallInfo {
 
 using CallInfoConstIterType = MapType<StringType, CallInfo>::const_iterator;
 
+/**
+ * Dense ID of an object, assigned when the object is added to an EquivClassContainer
+ */
+using ObjectId = std::size_t;
+
+/**
+ * A call (second) that can call the function object (first)
+ */
+using FunctionCallToMerge = std::pair<ObjectId, CallInfoConstIterType>;
+
 /**
  * This struct contains all data that is required for serialization and deserialization of equivalence classes,
- * including prefixes, Function and Call Info. FindMap and ReferencedInCalls are not serialized but recreated
+ * including prefixes, Function and Call Info.
+ * The equivalence classes are a disjoint-set forest over the object IDs, using path compression and union by rank.
+ * Prefixes, function objects and calls are stored at the representative of each class. Only the objects and prefixes
+ * of the classes are serialized, the object IDs and the per class function objects and calls are recreated.
  */
 struct EquivClassContainer {
   EquivClassContainer() = default;
 
-  ListType<EquivClass> EquivClasses;  // std::list for stable iterators
-
   MapType<StringType, StringType> FunctionMap;  // Maps an equivalence class to a function name if it is one
   // map to keep element order consistent
   MapType<StringType, FunctionInfo>
       FunctionInfoMap;                        // Maps the string identifier of a function to information about it
   MapType<StringType, CallInfo> CallInfoMap;  // Maps the string identifier of a call to its call information
-  MapType<StringType, EquivClassesIterator> FindMap;
   MapType<StringType, StringType> CallExprParentMap;  // Maps each call expr (Key) to the function containing it
 
-  MapType<StringType, VectorType<CallInfoConstIterType>>
-      ReferencedInCalls;  // Maps Objects to the calls which call them
+  // Indexed by ObjectId, only valid for the representative of a class
+  VectorType<VectorType<Prefix>> Prefixes;  // Sorted by member, at most one prefix per member
+  VectorType<VectorType<ObjectId>> FunctionObjects;                 // Objects of the class that are in FunctionMap
+  VectorType<VectorType<CallInfoConstIterType>> ReferencedInCalls;  // Calls which call an object of the class
+  VectorType<bool> CallsReported;  // The function calls within the class have been reported by a merge
+
+  /**
+   * Adds Obj as a single element class, if it is not known yet
+   * @return The ID of Obj
+   */
+  ObjectId addObject(const StringType& Obj);
+
+  /**
+   * @return The ID of Obj, or an empty optional if it is not known
+   */
+  std::optional<ObjectId> findObject(const StringType& Obj) const;
+
+  /**
+   * ID of an object that has to be known
+   */
+  ObjectId getObjectId(const StringType& Obj) const;
+
+  const StringType& getObjectName(ObjectId Id) const { return ObjectNames[Id]; }
+
+  std::size_t getNumObjects() const { return ObjectNames.size(); }
+
+  /**
+   * The representative of the class of Id. Compresses the path from Id to it.
+   */
+  ObjectId find(ObjectId Id) const;
+
+  bool inSameClass(ObjectId Id1, ObjectId Id2) const { return find(Id1) == find(Id2); }
+
+  /**
+   * Links the classes of the representatives Rep1 and Rep2 by rank and moves the smaller function object and call
+   * lists into the larger ones. Prefixes are left to the caller.
+   * @return The representative of the united class
+   */
+  ObjectId unite(ObjectId Rep1, ObjectId Rep2);
+
+  /**
+   * Adds P to the prefixes of the class of Id
+   */
+  void addPrefix(ObjectId Id, Prefix P);
+
+  /**
+   * The equivalence classes with their objects in ID order, as they are serialized
+   */
+  VectorType<EquivClass> getEquivClasses() const;
 
   /**
-   * Walks true all calls and finds the referenced callee (this can be an unresolved pointer).
+   * Walks true all calls and finds the referenced callee (this can be an unresolved pointer). Recreates the function
+   * objects and calls of all classes.
    */
-  void InitReferencedInCalls();
+  void InitClassIndices();
+
+ private:
+  VectorType<StringType> ObjectNames;
+  HashMapType<StringType, ObjectId> ObjectIds;
+  mutable VectorType<ObjectId> Parents;
+  VectorType<unsigned char> Ranks;
+};
+
+struct RecursiveMergeResult {
+  VectorType<FunctionCallToMerge> FunctionCalls;  // The function calls that became possible through the merges
+  std::size_t NumMerges = 0;                      // Number of merge steps, i.e., united pairs of classes
 };
 
 /**
- * Merges the two Equivalence Classes pointed to by E1 and E2
- * @param Data
- * @param E1
- * @param E2
- * @return
- * Classes
+ * Merges the classes of the objects E1 and E2, and transitively all classes that have to be merged because of their
+ * prefixes. Uses an explicit worklist, so the depth of the prefix propagation is not limited by the stack.
  */
-std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, EquivClassesIterator> mergeRecurisve(
-    EquivClassContainer& Data, EquivClassesIterator E1, EquivClassesIterator E2);
+RecursiveMergeResult mergeRecurisve(EquivClassContainer& Data, ObjectId E1, ObjectId E2);
 
 struct MergeResult {
-  MapType<StringType, EquivClassesIterator>::const_iterator Iter;
+  ObjectId Representative;
   VectorType<std::pair<StringType, StringType>> ObjectsToMerge;
+  /**
+   * Calls that were not possible within either of the two classes. The calls within a class are reported once, on the
+   * first merge of the class.
+   */
+  VectorType<FunctionCallToMerge> FunctionCalls;
 };
 
-MergeResult merge(EquivClassContainer& Data, EquivClassesIterator E1, EquivClassesIterator E2);
+MergeResult merge(EquivClassContainer& Data, ObjectId E1, ObjectId E2);
 
 /**
  *
  * @param Data
- * @param Ret All function merges resulting from the creation of class E
- * @param E
+ * @param Ret All function merges possible within the class of the representative Rep
+ * @param Rep
  */
-void GetFunctionsToMerge(const EquivClassContainer& Data, VectorType<std::pair<StringType, CallInfoConstIterType>>& Ret,
-                         const EquivClass& E);
+void GetFunctionsToMerge(const EquivClassContainer& Data, VectorType<FunctionCallToMerge>& Ret, ObjectId Rep);
 
 /**
  *
@@ -354,14 +426,18 @@ void GetFunctionsToMerge(const EquivClassContainer& Data, VectorType<std::pair<S
  * @return If the merge was done, functions to merge as a result of it, the name of the calling function (first) and of
  * the called function (second)
  */
-std::optional<std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, std::pair<StringType, StringType>>>
-mergeFunctionCall(EquivClassContainer& Data, const StringType& CalledObj, CallInfoConstIterType CE);
+std::optional<std::pair<VectorType<FunctionCallToMerge>, std::pair<StringType, StringType>>> mergeFunctionCall(
+    EquivClassContainer& Data, ObjectId CalledObj, CallInfoConstIterType CE);
 
-std::optional<std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, std::pair<StringType, StringType>>>
-mergeFunctionCallImpl(EquivClassContainer& Data, const StringType& CalledFunctionName,
-                      const StringType& CallingFunctionName, const CallInfo& CI, const StringType& CallExprUSR);
+std::optional<std::pair<VectorType<FunctionCallToMerge>, std::pair<StringType, StringType>>> mergeFunctionCallImpl(
+    EquivClassContainer& Data, const StringType& CalledFunctionName, const StringType& CallingFunctionName,
+    const CallInfo& CI, const StringType& CallExprUSR);
 
-void GetPrefixesToMerge(EquivClass& EquivClassToMergeInto, const VectorType<Prefix>& PrefixToMerge,
+/**
+ * Adds the prefixes of PrefixToMerge that have no counterpart in PrefixesToMergeInto, which has to be sorted by member.
+ * For prefixes with the same member but different objects, the objects are added to ObjectsToMerge.
+ */
+void GetPrefixesToMerge(VectorType<Prefix>& PrefixesToMergeInto, const VectorType<Prefix>& PrefixToMerge,
                         VectorType<std::pair<StringType, StringType>>& ObjectsToMerge);
 
 /**
@@ -614,11 +690,14 @@ class ASTInformationExtractor : public clang::RecursiveASTVisitor<ASTInformation
    * @param CalledObj
    * @param CE
    */
-  void mergeFunctionCall(const StringType& CalledObj, CallInfoConstIterType CE);
+  void mergeFunctionCall(ObjectId CalledObj, CallInfoConstIterType CE);
 
   void addCallToCallGraph(const StringType& CallingFunctionName, const StringType& CalledFunctionName);
 
-  void merge(EquivClassesIterator E1, EquivClassesIterator E2);
+  /**
+   * Merges the classes of the known objects O1 and O2, if they differ
+   */
+  void merge(const StringType& O1, const StringType& O2);
 
   EquivClassContainer Data;
 
@@ -639,26 +718,34 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Prefix, Object, Member)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(EquivClass, Objects, Prefixes)
 
 inline void to_json(nlohmann::json& J, const EquivClassContainer& C) {
-  J["EquivClasses"] = C.EquivClasses;
+  J["EquivClasses"] = C.getEquivClasses();
   J["FunctionMap"] = C.FunctionMap;
   J["FunctionInfoMap"] = C.FunctionInfoMap;
   J["CallInfoMap"] = C.CallInfoMap;
   J["CallExprParentMap"] = C.CallExprParentMap;
 }
 inline void from_json(const nlohmann::json& J, EquivClassContainer& C) {
-  J.at("EquivClasses").get_to(C.EquivClasses);
   J.at("FunctionMap").get_to(C.FunctionMap);
   J.at("FunctionInfoMap").get_to(C.FunctionInfoMap);
   J.at("CallInfoMap").get_to(C.CallInfoMap);
   J.at("CallExprParentMap").get_to(C.CallExprParentMap);
 
-  for (auto It = C.EquivClasses.begin(); It != C.EquivClasses.end(); ++It) {
-    for (const auto& Obj : It->Objects) {
-      C.FindMap.emplace(Obj, It);
+  for (const auto& JClass : J.at("EquivClasses")) {
+    const auto EC = JClass.get<EquivClass>();
+    assert(!EC.Objects.empty());
+    const auto First = C.addObject(EC.Objects.front());
+    for (const auto& Obj : EC.Objects) {
+      const auto Id = C.addObject(Obj);
+      if (!C.inSameClass(First, Id)) {
+        C.unite(C.find(First), C.find(Id));
+      }
+    }
+    for (const auto& P : EC.Prefixes) {
+      C.addPrefix(First, P);
     }
   }
 
-  C.InitReferencedInCalls();
+  C.InitClassIndices();
 }
 
 }  // namespace implementation
@@ -12,4 +12,10 @@ void addMetaInformationToJSON(nlohmann::json& j, const std::string& metaInformat
                               const std::map<std::string, std::unique_ptr<MetaInformation>>& meta,
                               int mcgFormatVersion);
 
+/**
+ * Merges the call graph of a single translation unit into the whole program call graph j, functions contained in both
+ * are merged with mergeFunctionJSON. PointerEquivalenceData is not merged.
+ */
+void mergeTranslationUnitJSON(nlohmann::json& j, const nlohmann::json& tu, int mcgFormatVersion);
+
 #endif /* ifndef CGCOLLECTOR_CALLGRAPHTOJSON_H */
@@ -172,6 +172,14 @@ struct FunctionInfo {
   std::unordered_map<std::string, MetaInformation*> metaInfo;
 };
 
+/**
+ * Merges the entry v of a function into its entry c of a whole program call graph, following the rules of cgmerge:
+ * edges and override relations are united, the meta information is taken from the entry that contains the definition
+ * of the function, estimated call counts and loop call depths are combined. If both entries contain a definition with
+ * a different number of statements, the numbers are added up.
+ */
+void mergeFunctionJSON(nlohmann::json& c, const nlohmann::json& v, int mcgFormatVersion);
+
 typedef std::map<std::string, FunctionInfo> FuncMapT;
 
 nlohmann::json buildFromJSON(FuncMapT& functionMap, const std::string& filename);
@@ -18,10 +18,13 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <iostream>
 #include <llvm/Support/CommandLine.h>
 
+class FusedMetaCollector;
+
 class MetaCollector {
   std::string name;
 
@@ -35,13 +38,24 @@ class MetaCollector {
   MetaCollector(std::string name) : name(name) {}
 
  public:
+  virtual ~MetaCollector() = default;
+
+  /**
+   * Calculates the meta information of all collectors in mcs.
+   * The function bodies are traversed once for all FusedMetaCollectors, the other collectors run separately.
+   */
+  static void calculateForAll(const CallGraph& cg, const std::vector<MetaCollector*>& mcs);
+
+  /** Returns this collector if it is a FusedMetaCollector, nullptr otherwise */
+  virtual FusedMetaCollector* asFusedMetaCollector() { return nullptr; }
+
   void calculateFor(const CallGraph& cg) {
     // for (auto &node : cg) {
     for (const auto& node : cg.getInOrderDecls()) {
       // if (node.first) {
       // if (auto f = llvm::dyn_cast<clang::FunctionDecl>(node.first)) {
       if (auto f = llvm::dyn_cast<clang::FunctionDecl>(node)) {
-        auto names = getMangledName(f);
+        const auto& names = MangledNameService::get(f->getASTContext()).getMangledNames(f);
         for (const auto& n : names) {
           values[n] = calculateForFunctionDecl(f, cg.CalledDecls);
         }
@@ -58,6 +72,68 @@ class MetaCollector {
   std::string getName() { return name; }
 };
 
+/**
+ * A collector that derives its meta information from the statements of a function body.
+ * Instead of walking the body itself, it is notified of every statement by a traversal shared by all fused
+ * collectors, see MetaCollector::calculateForAll.
+ */
+class FusedMetaCollector : public MetaCollector, public BodyStmtListener {
+ protected:
+  FusedMetaCollector(std::string name) : MetaCollector(name) {}
+
+ public:
+  FusedMetaCollector* asFusedMetaCollector() override { return this; }
+
+  /** Resets the per-function state before the body of decl is traversed */
+  virtual void beginFunction(const clang::FunctionDecl* decl) = 0;
+
+  /** Creates the meta information of decl after its body was traversed, can be called more than once */
+  virtual std::unique_ptr<MetaInformation> endFunction(
+      const clang::FunctionDecl* decl,
+      const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>& calledDecls) = 0;
+
+ private:
+  std::unique_ptr<MetaInformation> calculateForFunctionDecl(
+      clang::FunctionDecl const* const decl,
+      const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>& calledDecls) final {
+    beginFunction(decl);
+    BodyStmtListener* listener = this;
+    traverseFunctionBody(decl->getBody(), listener);
+    return endFunction(decl, calledDecls);
+  }
+};
+
+inline void MetaCollector::calculateForAll(const CallGraph& cg, const std::vector<MetaCollector*>& mcs) {
+  std::vector<MetaCollector*> fusedCollectors;
+  std::vector<BodyStmtListener*> listeners;
+  for (const auto mc : mcs) {
+    if (const auto fused = mc->asFusedMetaCollector()) {
+      fusedCollectors.push_back(mc);
+      listeners.push_back(fused);
+    } else {
+      mc->calculateFor(cg);
+    }
+  }
+  if (fusedCollectors.empty()) {
+    return;
+  }
+
+  for (const auto& node : cg.getInOrderDecls()) {
+    if (auto f = llvm::dyn_cast<clang::FunctionDecl>(node)) {
+      for (const auto mc : fusedCollectors) {
+        mc->asFusedMetaCollector()->beginFunction(f);
+      }
+      traverseFunctionBody(f->getBody(), listeners);
+      const auto& names = MangledNameService::get(f->getASTContext()).getMangledNames(f);
+      for (const auto mc : fusedCollectors) {
+        for (const auto& n : names) {
+          mc->values[n] = mc->asFusedMetaCollector()->endFunction(f, cg.CalledDecls);
+        }
+      }
+    }
+  }
+}
+
 class NumberOfStatementsCollector final : public MetaCollector {
   std::unique_ptr<MetaInformation> calculateForFunctionDecl(
       clang::FunctionDecl const* const decl,
@@ -307,78 +383,96 @@ class UniqueTypeCollector : public MetaCollector {
   UniqueTypeCollector() : MetaCollector("uniqueTypeCollector") {}
 };
 
-class NumConditionalBranchCollector final : public MetaCollector {
+class NumConditionalBranchCollector final : public FusedMetaCollector {
  public:
-  NumConditionalBranchCollector() : MetaCollector("numConditionalBranches") {}
+  NumConditionalBranchCollector() : FusedMetaCollector("numConditionalBranches") {}
 
- private:
-  std::unique_ptr<MetaInformation> calculateForFunctionDecl(
-      const clang::FunctionDecl* const decl,
+  void beginFunction([[maybe_unused]] const clang::FunctionDecl* decl) override { counter = {}; }
+
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override { counter.visitStmt(stmt, loopDepth); }
+
+  std::unique_ptr<MetaInformation> endFunction(
+      [[maybe_unused]] const clang::FunctionDecl* decl,
       const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>&) override {
     auto result = std::make_unique<NumOfConditionalBranchesResult>();
-    result->numberOfConditionalBranches = getNumConditionalBranchesInStmt(decl->getBody());
+    result->numberOfConditionalBranches = counter.count;
     return result;
   }
+
+ private:
+  NumConditionalBranchListener counter;
 };
 
-class NumOperationsCollector final : public MetaCollector {
+class NumOperationsCollector final : public FusedMetaCollector {
  public:
-  NumOperationsCollector() : MetaCollector("numOperations") {}
+  NumOperationsCollector() : FusedMetaCollector("numOperations") {}
 
- private:
-  std::unique_ptr<MetaInformation> calculateForFunctionDecl(
-      const clang::FunctionDecl* const decl,
-      const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>&) override {
+  void beginFunction([[maybe_unused]] const clang::FunctionDecl* decl) override { counter.reset(); }
+
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override { counter.visitStmt(stmt, loopDepth); }
+
+  std::unique_ptr<MetaInformation> endFunction(
+      const clang::FunctionDecl* decl, const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>&) override {
     assert(decl);
     auto result = std::make_unique<NumOperationsResult>();
-    const auto counts = getNumOperationsInStmt(decl->getBody());
+    const auto counts = counter.getResult();
     result->numberOfIntOps = counts.numberOfIntOps;
     result->numberOfFloatOps = counts.numberOfFloatOps;
     result->numberOfControlFlowOps = counts.numberOfControlFlowOps;
     result->numberOfMemoryAccesses = counts.numberOfMemoryAccesses;
     return result;
   }
+
+ private:
+  NumOperationsListener counter;
 };
 
-class LoopDepthCollector final : public MetaCollector {
+class LoopDepthCollector final : public FusedMetaCollector {
  public:
-  LoopDepthCollector() : MetaCollector("loopDepth") {}
+  LoopDepthCollector() : FusedMetaCollector("loopDepth") {}
 
- private:
-  std::unique_ptr<MetaInformation> calculateForFunctionDecl(
-      const clang::FunctionDecl* const decl,
-      const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>&) override {
+  void beginFunction([[maybe_unused]] const clang::FunctionDecl* decl) override { counter = {}; }
+
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override { counter.visitStmt(stmt, loopDepth); }
+
+  std::unique_ptr<MetaInformation> endFunction(
+      const clang::FunctionDecl* decl, const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>&) override {
     assert(decl);
     auto result = std::make_unique<LoopDepthResult>();
-    result->loopDepth = getLoopDepthInStmt(decl->getBody());
+    result->loopDepth = counter.maxDepth;
     return result;
   }
+
+ private:
+  LoopDepthListener counter;
 };
 
-class GlobalLoopDepthCollector final : public MetaCollector {
+class GlobalLoopDepthCollector final : public FusedMetaCollector {
  public:
-  GlobalLoopDepthCollector() : MetaCollector("loopCallDepth") {}
+  GlobalLoopDepthCollector() : FusedMetaCollector("loopCallDepth") {}
   void addMetaInformationToCompleteJson(nlohmann::json& j, int mcgFormatVersion) override {
     if (mcgFormatVersion > 1) {
       calculateGlobalCallDepth(j, false);
     }
   }
 
- private:
-  std::unique_ptr<MetaInformation> calculateForFunctionDecl(
-      const clang::FunctionDecl* const decl,
+  void beginFunction([[maybe_unused]] const clang::FunctionDecl* decl) override { counter = {}; }
+
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override { counter.visitStmt(stmt, loopDepth); }
+
+  std::unique_ptr<MetaInformation> endFunction(
+      const clang::FunctionDecl* decl,
       const llvm::DenseMap<const clang::CallExpr*, const clang::Decl*>& calledDecls) override {
     assert(decl);
     auto result = std::make_unique<GlobalLoopDepthResult>();
     std::map<std::string, int> calledFunctions;
-    const auto callDepths = getCallDepthsInStmt(decl->getBody());
-    for (const auto& c : callDepths) {
+    for (const auto& c : counter.calls) {
       const auto i = calledDecls.find(c.first);
       // There are unfortunately some cases where we can not map the call to what is called
       if (i != calledDecls.end()) {
         // TODO: Maybe handle constructors
         if (auto fdecl = llvm::dyn_cast<clang::FunctionDecl>(i->getSecond())) {
-          const auto fnames = getMangledName(fdecl);
+          const auto& fnames = MangledNameService::get(fdecl->getASTContext()).getMangledNames(fdecl);
           for (const auto& fname : fnames) {
             auto fi = calledFunctions.find(fname);
             if (fi == calledFunctions.end()) {
@@ -393,6 +487,9 @@ class GlobalLoopDepthCollector final : public MetaCollector {
     result->calledFunctions = calledFunctions;
     return result;
   }
+
+ private:
+  CallDepthListener counter;
 };
 
 class InlineCollector final : public MetaCollector {
@@ -470,7 +567,7 @@ class EstimateCallCountCollector final : public MetaCollector {
       if (const auto calledDeclsIter = calledDecls.find(callCount.first); calledDeclsIter != calledDecls.end()) {
         // TODO: Maybe handle constructors
         if (auto fdecl = llvm::dyn_cast<clang::FunctionDecl>(calledDeclsIter->getSecond())) {
-          const auto fnames = getMangledName(fdecl);
+          const auto& fnames = MangledNameService::get(fdecl->getASTContext()).getMangledNames(fdecl);
           for (const auto& fname : fnames) {
             for (const auto& cc : callCount.second) {
               {
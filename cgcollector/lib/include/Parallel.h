@@ -0,0 +1,25 @@
+#ifndef CGCOLLECTOR_PARALLEL_H
+#define CGCOLLECTOR_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * The number of threads used for numItems independent items
+ * @param jobs The requested number of threads, 0 uses all hardware threads
+ */
+std::size_t getNumWorkers(std::size_t numItems, unsigned jobs = 0);
+
+/**
+ * Runs worker(i) for every i in [0, numWorkers) on its own thread, on the calling thread if there is only one worker,
+ * and waits for all of them. The first exception thrown by a worker is rethrown once all workers finished.
+ */
+void runWorkers(std::size_t numWorkers, const std::function<void(std::size_t)>& worker);
+
+/**
+ * Calls fn(i) for every i in [0, numItems) on getNumWorkers(numItems, jobs) threads. The items are claimed one by one,
+ * so items of different cost are balanced across the threads.
+ */
+void parallelFor(std::size_t numItems, const std::function<void(std::size_t)>& fn, unsigned jobs = 0);
+
+#endif  // CGCOLLECTOR_PARALLEL_H
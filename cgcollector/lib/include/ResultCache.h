@@ -0,0 +1,61 @@
+#ifndef CGCOLLECTOR_RESULTCACHE_H
+#define CGCOLLECTOR_RESULTCACHE_H
+
+#include <nlohmann/json.hpp>
+
+#include <llvm/ADT/StringRef.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * On-disk cache of the per translation unit results of cgcollector.
+ * Entries are keyed by the content of the source file and a configuration string, which has to cover everything else
+ * the result depends on, i.e., the compile command and the collector options. An entry records the files included by
+ * the translation unit with their content hashes and the paths that were looked up but did not exist. It is only used
+ * if none of the included files changed and none of the missing files was created, e.g., a header that shadows an
+ * included one on the include search path. Thus, the result of an unchanged translation unit is returned without
+ * preprocessing it or building its AST.
+ * Entries are written atomically, so multiple cgcollector processes can share a cache directory.
+ */
+class ResultCache {
+ public:
+  explicit ResultCache(std::string cacheDir);
+
+  /**
+   * Hex digest of content
+   */
+  static std::string hashContent(llvm::StringRef content);
+
+  /**
+   * Hex digest of the content of the file at path, empty if it cannot be read
+   */
+  static std::string hashFile(const std::string& path);
+
+  /**
+   * Key of the translation unit sourceFile, empty if the source file cannot be read
+   */
+  static std::string computeKey(const std::string& sourceFile, const std::string& configuration);
+
+  /**
+   * Returns the cached result of key, if there is one, all of its dependencies are unchanged and none of its missing
+   * files exists
+   */
+  std::optional<nlohmann::json> lookup(const std::string& key) const;
+
+  /**
+   * Stores result under key, together with the current content hashes of its dependencies and the paths of the files
+   * that must not exist for the result to stay valid
+   * @return False if the entry could not be written
+   */
+  bool store(const std::string& key, const std::vector<std::string>& dependencies,
+             const std::vector<std::string>& missingFiles, const nlohmann::json& result) const;
+
+ private:
+  std::string getEntryPath(const std::string& key) const;
+
+  std::string cacheDir;
+};
+
+#endif  // CGCOLLECTOR_RESULTCACHE_H
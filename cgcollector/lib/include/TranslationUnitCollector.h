@@ -0,0 +1,89 @@
+#ifndef CGCOLLECTOR_TRANSLATIONUNITCOLLECTOR_H
+#define CGCOLLECTOR_TRANSLATIONUNITCOLLECTOR_H
+
+#include "MetaCollector.h"
+
+#include <nlohmann/json.hpp>
+
+#include <clang/Basic/FileManager.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Options of the call graph construction of a translation unit
+ */
+struct CollectorOptions {
+  bool captureCtorsDtors = false;
+  bool inferCtorDtorCalls = true;
+  bool captureStackCtorsDtors = false;
+  bool includeUnusedDecl = false;
+  bool disableClassicCGConstruction = false;
+  bool enableAA = false;
+  int metacgFormatVersion = 1;
+  // Configuration for the call count estimation
+  float loopCountEstimation = 100.0;
+  float conditionTrueChance = 0.5;
+  float exceptionChance = 0.1;
+};
+
+using MetaCollectorList = std::vector<std::unique_ptr<MetaCollector>>;
+
+/**
+ * Every translation unit gets its own set of collectors, as they store their results per instance
+ */
+MetaCollectorList createMetaCollectors(const CollectorOptions& options);
+
+/**
+ * Everything besides the source, its includes and the compile command the result of a translation unit depends on
+ */
+std::string getOptionsConfiguration(const CollectorOptions& options);
+
+/**
+ * The working directory of the compile command of a translation unit, empty if there is none
+ */
+std::string getCompileDirectory(const clang::tooling::CompilationDatabase& compilations, const std::string& sourceFile);
+
+/**
+ * State that is reused for the translation units of one compile directory processed by one worker. Files that are
+ * included by several translation units are looked up in the file system only once. The file manager caches lookups by
+ * the path as spelled, so a relative include resolves to a different file in another compile directory.
+ * Not thread-safe, every worker needs its own workspaces.
+ */
+struct CollectorWorkspace {
+  explicit CollectorWorkspace(std::string directory);
+
+  const std::string directory;
+  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fileSystem;
+  llvm::IntrusiveRefCntPtr<clang::FileManager> fileManager;
+  std::shared_ptr<clang::PCHContainerOperations> pchContainerOps;
+};
+
+/**
+ * Files the result of a translation unit depends on
+ */
+struct TranslationUnitDependencies {
+  // Absolute paths of all files the translation unit includes
+  std::vector<std::string> includedFiles;
+  // Absolute paths that were looked up but did not exist, e.g., the include directories searched before the one a
+  // header was found in. Creating one of them may change the result.
+  std::vector<std::string> missingFiles;
+};
+
+/**
+ * Builds the call graph of a single translation unit, including the per-function meta information
+ * @param dependencies If not null, receives the files the translation unit depends on. Not supported together with a
+ * workspace, as its file manager does not look up files again that earlier translation units looked up.
+ * @param workspace If not null, the translation unit is processed with the file manager of the workspace. The workspace
+ * has to belong to the compile directory of the translation unit.
+ */
+int collectTranslationUnit(const clang::tooling::CompilationDatabase& compilations, const std::string& sourceFile,
+                           const CollectorOptions& options, nlohmann::json& j,
+                           TranslationUnitDependencies* dependencies = nullptr,
+                           CollectorWorkspace* workspace = nullptr);
+
+#endif  // CGCOLLECTOR_TRANSLATIONUNITCOLLECTOR_H
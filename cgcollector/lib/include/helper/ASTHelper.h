@@ -3,6 +3,8 @@
 
 #include "clang/AST/Stmt.h"
 #include "clang/AST/StmtCXX.h"
+#include "llvm/ADT/ArrayRef.h"
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -34,6 +36,58 @@ int getLoopDepthInStmt(clang::Stmt* s);
 
 llvm::SmallDenseMap<const clang::CallExpr*, int, 16> getCallDepthsInStmt(clang::Stmt* s);
 
+/**
+ * Receives the statements of a function body from traverseFunctionBody
+ */
+class BodyStmtListener {
+ public:
+  virtual ~BodyStmtListener() = default;
+  /**
+   * Called once for every statement (including expressions) in the order of a RecursiveASTVisitor
+   * @param loopDepth Number of loops enclosing stmt, including stmt itself if it is a loop
+   */
+  virtual void visitStmt(clang::Stmt* stmt, int loopDepth) = 0;
+};
+
+/**
+ * Traverses body once and passes every statement to all listeners.
+ * The listeners see exactly the statements the get*InStmt functions above see, so any number of them can share a
+ * single traversal.
+ */
+void traverseFunctionBody(clang::Stmt* body, llvm::ArrayRef<BodyStmtListener*> listeners);
+
+class NumConditionalBranchListener final : public BodyStmtListener {
+ public:
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override;
+  int count = 0;
+};
+
+class NumOperationsVisitor;
+
+class NumOperationsListener final : public BodyStmtListener {
+ public:
+  NumOperationsListener();
+  ~NumOperationsListener() override;
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override;
+  NumOperations getResult() const;
+  void reset();
+
+ private:
+  std::unique_ptr<NumOperationsVisitor> visitor;
+};
+
+class LoopDepthListener final : public BodyStmtListener {
+ public:
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override;
+  int maxDepth = 0;
+};
+
+class CallDepthListener final : public BodyStmtListener {
+ public:
+  void visitStmt(clang::Stmt* stmt, int loopDepth) override;
+  llvm::SmallDenseMap<const clang::CallExpr*, int, 16> calls;
+};
+
 /**
  * Information collected for the call count estimation.
  * It maps call expressions to their parents and a factor of how their parents influence how often the call expression
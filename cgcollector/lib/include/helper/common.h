@@ -1,16 +1,51 @@
 #ifndef CGCOLLECTOR_HELPER_COMMON_H
 #define CGCOLLECTOR_HELPER_COMMON_H
 
+#include <clang/AST/ASTContext.h>
 #include <clang/AST/ExprCXX.h>
 #include <clang/AST/Mangle.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+/**
+ * Mangled names of the declarations of one ASTContext.
+ * Owns a single ASTNameGenerator and MangleContext and memoizes the names per declaration. There is one instance per
+ * ASTContext and thread, it is released together with its ASTContext.
+ */
+class MangledNameService {
+ public:
+  /**
+   * Returns the service of ctx, creating it on first use
+   */
+  static MangledNameService& get(clang::ASTContext& ctx);
+
+  /**
+   * Returns mangled names for all named decls, including Ctor/Dtor.
+   */
+  const std::vector<std::string>& getMangledNames(const clang::NamedDecl* nd);
+
+  /**
+   * Returns all potential manglings of a constructor or destructor, an empty list for other functions.
+   */
+  const std::vector<std::string>& getCtorDtorManglings(const clang::FunctionDecl* fd);
+
+ private:
+  explicit MangledNameService(clang::ASTContext& ctx);
+
+  clang::ASTNameGenerator nameGenerator;
+  std::unique_ptr<clang::MangleContext> mangleContext;
+  std::unordered_map<const clang::NamedDecl*, std::vector<std::string>> mangledNames;
+  std::unordered_map<const clang::FunctionDecl*, std::vector<std::string>> ctorDtorManglings;
+};
+
 /**
  * Returns mangled names for all named decls, including Ctor/Dtor.
+ * Shorthand for MangledNameService::get(nd->getASTContext()).getMangledNames(nd)
  */
-std::vector<std::string> getMangledName(clang::NamedDecl const* const nd);
+const std::vector<std::string>& getMangledName(clang::NamedDecl const* const nd);
 
 /**
  * Returns the called Statement from a CXXMemberCall
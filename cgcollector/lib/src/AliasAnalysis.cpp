@@ -6,6 +6,7 @@
 
 #include <clang/Index/USRGeneration.h>
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 
@@ -229,7 +230,7 @@ void ASTInformationExtractor::dump() {
     llvm::errs() << O.GetStringRepr() << "\n";
   }
   llvm::errs() << "Equiv Classes:\n";
-  for (auto& EquivClasse : Data.EquivClasses) {
+  for (const auto& EquivClasse : Data.getEquivClasses()) {
     llvm::errs() << "Class: {";
     for (const auto& O : EquivClasse.Objects) {
       llvm::errs() << O << ", ";
@@ -400,8 +401,7 @@ bool ASTInformationExtractor::VisitBinaryOperator(clang::BinaryOperator* BO) {
 void ASTInformationExtractor::initEquivClasses() {
   for (const auto& Object : Objects) {
     const auto StringRepr = Object.GetStringRepr();
-    Data.EquivClasses.emplace_front(StringRepr);
-    Data.FindMap.emplace(StringRepr, Data.EquivClasses.begin());
+    Data.addObject(StringRepr);
     if (Object.GetFunctionName()) {
       Data.FunctionMap.emplace(StringRepr, Object.GetFunctionName().value());
     }
@@ -415,8 +415,7 @@ void ASTInformationExtractor::initPrefixClasses() {
     Tmp.DereferenceLevel += 1;
     auto TmpObject = Objects.find(Tmp);
     if (TmpObject != Objects.end()) {
-      auto& Pre = Data.FindMap[Object.GetStringRepr()]->Prefixes;
-      Pre.emplace_back((*TmpObject));
+      Data.addPrefix(Data.getObjectId(Object.GetStringRepr()), Prefix(*TmpObject));
     } else {
       // Line 7 - 8 These lines are in the original algorithm description, but I don't really see how they differ from
       // the previous two. In practice this code leads to duplications in the prefix classes
@@ -432,8 +431,7 @@ void ASTInformationExtractor::initPrefixClasses() {
       const auto Tmp = Object.getMb()->DB;
       const auto TmpObject = Objects.find(Tmp);
       if (TmpObject != Objects.end()) {
-        auto& Pre = Data.FindMap[TmpObject->GetStringRepr()]->Prefixes;
-        Pre.emplace_back(Object, Object.getMb()->Member);
+        Data.addPrefix(Data.getObjectId(TmpObject->GetStringRepr()), Prefix(Object, Object.getMb()->Member));
       }
     }
   }
@@ -442,7 +440,7 @@ void ASTInformationExtractor::initPrefixClasses() {
 void ASTInformationExtractor::calculatePERelation() {
   initEquivClasses();
   initPrefixClasses();
-  Data.InitReferencedInCalls();
+  Data.InitClassIndices();
 
   handleDirectCalls();
   handleDestructorCalls();
@@ -456,9 +454,14 @@ void ASTInformationExtractor::calculatePERelation() {
   // dump();
 }
 
-void ASTInformationExtractor::merge(EquivClassesIterator E1, EquivClassesIterator E2) {
-  const auto Ret = ::implementation::mergeRecurisve(Data, E1, E2);
-  for (const auto& [Obj, CE] : Ret.first) {
+void ASTInformationExtractor::merge(const StringType& O1, const StringType& O2) {
+  const auto Id1 = Data.getObjectId(O1);
+  const auto Id2 = Data.getObjectId(O2);
+  if (Data.inSameClass(Id1, Id2)) {
+    return;
+  }
+  const auto Ret = ::implementation::mergeRecurisve(Data, Id1, Id2);
+  for (const auto& [Obj, CE] : Ret.FunctionCalls) {
     mergeFunctionCall(Obj, CE);
   }
 }
@@ -469,14 +472,8 @@ void ASTInformationExtractor::handleAssignments() {
     const auto RHS = getReferencedDeclsStr(Assignment.first->getRHS(), CTX, Assignment.second);
     assert(!LHS.empty());
     for (const auto& L : LHS) {
-      const auto ItL = Data.FindMap.find(L);
-      assert(ItL != Data.FindMap.end());
       for (const auto& R : RHS) {
-        const auto ItR = Data.FindMap.find(R);
-        assert(ItR != Data.FindMap.end());
-        if (ItL->second != ItR->second) {
-          merge(ItL->second, ItR->second);
-        }
+        merge(L, R);
       }
     }
   }
@@ -540,14 +537,9 @@ void ASTInformationExtractor::handleInitExpr(const ObjectNameDereference* ObjDer
 
       } else {
         const auto Referenced = getReferencedDeclsStr(InitExpr, CTX, ParentFunctionDecl);
-        const auto LHS = Data.FindMap.find(ObjDeref->GetStringRepr());
-        assert(LHS != Data.FindMap.end());
+        const auto LHS = ObjDeref->GetStringRepr();
         for (const auto& R : Referenced) {
-          const auto RHS = Data.FindMap.find(R);
-          assert(RHS != Data.FindMap.end());
-          if (LHS->second != RHS->second) {
-            merge(LHS->second, RHS->second);
-          }
+          merge(LHS, R);
         }
       }
     }
@@ -555,14 +547,9 @@ void ASTInformationExtractor::handleInitExpr(const ObjectNameDereference* ObjDer
     // Simple types
     const auto Refs = getReferencedDeclsStr(InitExpr, CTX, ParentFunctionDecl);
     // Ref can be empty, for example if a variable is initialized with a literal expression
-    const auto ItObj = Data.FindMap.find(ObjDeref->GetStringRepr());
-    assert(ItObj != Data.FindMap.end());
+    const auto Obj = ObjDeref->GetStringRepr();
     for (const auto& Ref : Refs) {
-      const auto ItRef = Data.FindMap.find(Ref);
-      assert(ItRef != Data.FindMap.end());
-      if (ItObj->second != ItRef->second) {
-        merge(ItObj->second, ItRef->second);
-      }
+      merge(Obj, Ref);
     }
   }
 }
@@ -575,8 +562,8 @@ const clang::Type* ASTInformationExtractor::stripArrayType(const clang::Type* Ty
   return Type;
 }
 
-void ASTInformationExtractor::mergeFunctionCall(const StringType& CalledObj, CallInfoConstIterType CE) {
-  static std::unordered_set<std::pair<StringType, CallInfoConstIterType>> Cache;
+void ASTInformationExtractor::mergeFunctionCall(ObjectId CalledObj, CallInfoConstIterType CE) {
+  static std::unordered_set<std::pair<ObjectId, CallInfoConstIterType>> Cache;
   if (!Cache.emplace(std::make_pair(CalledObj, CE)).second) {
     return;
   }
@@ -638,13 +625,7 @@ void ASTInformationExtractor::handleMergeFunctionParameters() {
       assert(Decls1.size() == 1);
       const auto Decls2 = getDecls(F2Params[i], &F2->getASTContext());
       assert(Decls2.size() == 1);
-      const auto Iter1 = Data.FindMap.find(Decls1[0]);
-      assert(Iter1 != Data.FindMap.end());
-      const auto Iter2 = Data.FindMap.find(Decls2[0]);
-      assert(Iter2 != Data.FindMap.end());
-      if (Iter1->second != Iter2->second) {
-        merge(Iter1->second, Iter2->second);
-      }
+      merge(Decls1[0], Decls2[0]);
     }
   }
 }
@@ -690,36 +671,24 @@ bool ASTInformationExtractor::TraverseCXXDestructorDecl(clang::CXXDestructorDecl
 
 void ASTInformationExtractor::handleMergeCXXMembers() {
   for (const auto& MethodsToMerge : CXXMemberMergeList) {
-    const auto It1 = Data.FindMap.find(MethodsToMerge.first);
-    assert(It1 != Data.FindMap.end());
-    const auto It2 = Data.FindMap.find(MethodsToMerge.second);
-    assert(It2 != Data.FindMap.end());
-    if (It1->second != It2->second) {
-      merge(It1->second, It2->second);
-    }
+    merge(MethodsToMerge.first, MethodsToMerge.second);
   }
 }
 
 void ASTInformationExtractor::handleMergeCXXThisPointers() {
   for (const auto& ToMerge : ThisPointersToMerge) {
-    // We need to check all methods that share an EquivalenceClass with the called method
-    const auto CalledEquivClassIter = Data.FindMap.find(ToMerge.second);
-    assert(CalledEquivClassIter != Data.FindMap.end());
-    for (const auto& PotentialMethod : CalledEquivClassIter->second->Objects) {
-      const auto FoundMethodIter = Data.FunctionMap.find(PotentialMethod);
-      if (FoundMethodIter != Data.FunctionMap.end()) {
-        const auto ActuallyCalledMethod = FoundMethodIter->second;
-        // We found the called Method. Now we need to merge its 'this' pointer with the implicit object
-        const auto ThisUSR = generateUSRForThisExpr(ActuallyCalledMethod);
-        const auto ThisIter = Data.FindMap.find(ThisUSR);
-        // It could happen that a method without 'this' pointer is for some reason in the same equivalence class
-        if (ThisIter != Data.FindMap.end()) {
-          const auto CallingObjectIter = Data.FindMap.find(ToMerge.first);
-          assert(CallingObjectIter != Data.FindMap.end());
-          if (ThisIter->second != CallingObjectIter->second) {
-            merge(ThisIter->second, CallingObjectIter->second);
-          }
-        }
+    // We need to check all methods that share an EquivalenceClass with the called method. The class can grow by the
+    // merges below, so we iterate over a copy of its function objects
+    const auto PotentialMethods = Data.FunctionObjects[Data.find(Data.getObjectId(ToMerge.second))];
+    for (const auto PotentialMethod : PotentialMethods) {
+      const auto FoundMethodIter = Data.FunctionMap.find(Data.getObjectName(PotentialMethod));
+      assert(FoundMethodIter != Data.FunctionMap.end());
+      const auto ActuallyCalledMethod = FoundMethodIter->second;
+      // We found the called Method. Now we need to merge its 'this' pointer with the implicit object
+      const auto ThisUSR = generateUSRForThisExpr(ActuallyCalledMethod);
+      // It could happen that a method without 'this' pointer is for some reason in the same equivalence class
+      if (Data.findObject(ThisUSR)) {
+        merge(ThisUSR, ToMerge.first);
       }
     }
   }
@@ -842,13 +811,7 @@ bool ASTInformationExtractor::VisitFieldDecl(clang::FieldDecl* FD) {
 
 void ASTInformationExtractor::handleMergeOverrides() {
   for (const auto& ToMerge : OverridesToMerge) {
-    const auto ItFirst = Data.FindMap.find(ToMerge.first);
-    assert(ItFirst != Data.FindMap.end());
-    const auto ItSecond = Data.FindMap.find(ToMerge.second);
-    assert(ItSecond != Data.FindMap.end());
-    if (ItFirst->second != ItSecond->second) {
-      merge(ItFirst->second, ItSecond->second);
-    }
+    merge(ToMerge.first, ToMerge.second);
   }
 }
 
@@ -920,14 +883,8 @@ void ASTInformationExtractor::handleMergeConstructorAssignments() {
     const auto& LHS = Assignment.first;
     const auto& RHS = Assignment.second;
     assert(!LHS.empty());
-    const auto ItL = Data.FindMap.find(LHS);
-    assert(ItL != Data.FindMap.end());
     for (const auto& R : RHS) {
-      const auto ItR = Data.FindMap.find(R);
-      assert(ItR != Data.FindMap.end());
-      if (ItL->second != ItR->second) {
-        merge(ItL->second, ItR->second);
-      }
+      merge(LHS, R);
     }
   }
 }
@@ -1278,58 +1235,175 @@ CallInfo::CallInfo(clang::CXXConstructExpr* CE, const clang::ASTContext* CTX, cl
   }
 }
 
-void EquivClassContainer::InitReferencedInCalls() {
-  ReferencedInCalls.clear();
+namespace {
+
+bool lessByMember(const Prefix& LHS, const Prefix& RHS) { return LHS.Member < RHS.Member; }
+
+/**
+ * Appends From to Into, moving the shorter into the longer list
+ */
+template <typename T>
+void appendSmallToLarge(VectorType<T>& Into, VectorType<T>& From) {
+  if (Into.size() < From.size()) {
+    std::swap(Into, From);
+  }
+  Into.insert(Into.end(), From.begin(), From.end());
+  VectorType<T>().swap(From);
+}
+
+void appendFunctionCalls(const VectorType<ObjectId>& Functions, const VectorType<CallInfoConstIterType>& Calls,
+                         VectorType<FunctionCallToMerge>& Ret) {
+  for (const auto F : Functions) {
+    for (const auto C : Calls) {
+      Ret.emplace_back(F, C);
+    }
+  }
+}
+
+}  // namespace
+
+ObjectId EquivClassContainer::addObject(const StringType& Obj) {
+  const auto [It, Inserted] = ObjectIds.emplace(Obj, ObjectNames.size());
+  if (Inserted) {
+    ObjectNames.push_back(Obj);
+    Parents.push_back(It->second);
+    Ranks.push_back(0);
+    Prefixes.emplace_back();
+    FunctionObjects.emplace_back();
+    ReferencedInCalls.emplace_back();
+    CallsReported.push_back(false);
+  }
+  return It->second;
+}
+
+std::optional<ObjectId> EquivClassContainer::findObject(const StringType& Obj) const {
+  const auto It = ObjectIds.find(Obj);
+  if (It == ObjectIds.end()) {
+    return std::nullopt;
+  }
+  return It->second;
+}
+
+ObjectId EquivClassContainer::getObjectId(const StringType& Obj) const {
+  const auto It = ObjectIds.find(Obj);
+  assert(It != ObjectIds.end());
+  return It->second;
+}
+
+ObjectId EquivClassContainer::find(ObjectId Id) const {
+  auto Root = Id;
+  while (Parents[Root] != Root) {
+    Root = Parents[Root];
+  }
+  while (Parents[Id] != Root) {
+    const auto Next = Parents[Id];
+    Parents[Id] = Root;
+    Id = Next;
+  }
+  return Root;
+}
+
+ObjectId EquivClassContainer::unite(ObjectId Rep1, ObjectId Rep2) {
+  assert(Rep1 != Rep2);
+  assert(Parents[Rep1] == Rep1 && Parents[Rep2] == Rep2);
+  if (Ranks[Rep1] < Ranks[Rep2]) {
+    std::swap(Rep1, Rep2);
+  }
+  Parents[Rep2] = Rep1;
+  if (Ranks[Rep1] == Ranks[Rep2]) {
+    Ranks[Rep1]++;
+  }
+  appendSmallToLarge(FunctionObjects[Rep1], FunctionObjects[Rep2]);
+  appendSmallToLarge(ReferencedInCalls[Rep1], ReferencedInCalls[Rep2]);
+  CallsReported[Rep1] = CallsReported[Rep1] || CallsReported[Rep2];
+  return Rep1;
+}
+
+void EquivClassContainer::addPrefix(ObjectId Id, Prefix P) {
+  auto& ClassPrefixes = Prefixes[find(Id)];
+  const auto It = std::upper_bound(ClassPrefixes.begin(), ClassPrefixes.end(), P, lessByMember);
+  ClassPrefixes.insert(It, std::move(P));
+}
+
+VectorType<EquivClass> EquivClassContainer::getEquivClasses() const {
+  constexpr auto NoClass = std::numeric_limits<std::size_t>::max();
+  VectorType<EquivClass> Classes;
+  VectorType<std::size_t> ClassIndex(ObjectNames.size(), NoClass);
+  for (ObjectId Id = 0; Id < ObjectNames.size(); Id++) {
+    const auto Rep = find(Id);
+    if (ClassIndex[Rep] == NoClass) {
+      ClassIndex[Rep] = Classes.size();
+      Classes.emplace_back();
+      Classes.back().Prefixes = Prefixes[Rep];
+    }
+    Classes[ClassIndex[Rep]].Objects.push_back(ObjectNames[Id]);
+  }
+  return Classes;
+}
+
+void EquivClassContainer::InitClassIndices() {
+  for (auto& Functions : FunctionObjects) {
+    Functions.clear();
+  }
+  for (auto& Calls : ReferencedInCalls) {
+    Calls.clear();
+  }
+  for (const auto& Function : FunctionMap) {
+    if (const auto Id = findObject(Function.first)) {
+      FunctionObjects[find(*Id)].push_back(*Id);
+    }
+  }
   for (auto CallInfo = CallInfoMap.cbegin(); CallInfo != CallInfoMap.cend(); CallInfo++) {
-    const auto Refs = CallInfo->second.CalledObjects;
-    for (const auto& Ref : Refs) {
-      ReferencedInCalls[Ref].push_back(CallInfo);
+    for (const auto& Ref : CallInfo->second.CalledObjects) {
+      if (const auto Id = findObject(Ref)) {
+        ReferencedInCalls[find(*Id)].push_back(CallInfo);
+      }
     }
   }
 }
 
 EquivClass::EquivClass(StringType Obj) { Objects.emplace_back(std::move(Obj)); }
 
-std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, EquivClassesIterator> mergeRecurisve(
-    EquivClassContainer& Data, EquivClassesIterator E1, EquivClassesIterator E2) {
-  const auto MergeResult = merge(Data, E1, E2);
-  VectorType<std::pair<StringType, CallInfoConstIterType>> Ret;
-
-  // Merge function calls
-  for (const auto& Entry : MergeResult.ObjectsToMerge) {
-    auto F = Data.FindMap.find(Entry.first);
-    auto F1 = Data.FindMap.find(Entry.second);
-    assert(F != Data.FindMap.end());
-    assert(F1 != Data.FindMap.end());
-    if (F->second != F1->second) {
-      const auto Tmp = mergeRecurisve(Data, F->second, F1->second);
-      Ret.insert(Ret.end(), Tmp.first.begin(), Tmp.first.end());
+RecursiveMergeResult mergeRecurisve(EquivClassContainer& Data, ObjectId E1, ObjectId E2) {
+  RecursiveMergeResult Result;
+  VectorType<std::pair<ObjectId, ObjectId>> Worklist{{E1, E2}};
+  while (!Worklist.empty()) {
+    const auto [O1, O2] = Worklist.back();
+    Worklist.pop_back();
+    // Earlier merges of the worklist may already have united the classes
+    if (Data.inSameClass(O1, O2)) {
+      continue;
+    }
+    const auto MergeResult = merge(Data, O1, O2);
+    Result.NumMerges++;
+    Result.FunctionCalls.insert(Result.FunctionCalls.end(), MergeResult.FunctionCalls.begin(),
+                                MergeResult.FunctionCalls.end());
+    // Merge the classes of matching prefixes
+    for (const auto& Entry : MergeResult.ObjectsToMerge) {
+      Worklist.emplace_back(Data.getObjectId(Entry.first), Data.getObjectId(Entry.second));
     }
   }
-
-  GetFunctionsToMerge(Data, Ret, *MergeResult.Iter->second);
-  // We sadly can't reuse Iter here, as it can be invalidated by the merges of function calls
-  return {Ret, MergeResult.Iter->second};
+  return Result;
 }
 
-std::optional<std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, std::pair<StringType, StringType>>>
-mergeFunctionCall(EquivClassContainer& Data, const StringType& CalledObj, CallInfoConstIterType CE) {
+std::optional<std::pair<VectorType<FunctionCallToMerge>, std::pair<StringType, StringType>>> mergeFunctionCall(
+    EquivClassContainer& Data, ObjectId CalledObj, CallInfoConstIterType CE) {
   // TODO: A cache of already merged functions could be very useful here
   //  if (MergedCalls.find({CalledObj, CE}) != MergedCalls.end()) {
   //    return;
   //  }
 
-  const auto FunctionMapIter = Data.FunctionMap.find(CalledObj);
+  const auto FunctionMapIter = Data.FunctionMap.find(Data.getObjectName(CalledObj));
   assert(FunctionMapIter != Data.FunctionMap.end());
   const auto CalledFunctionName = FunctionMapIter->second;
   const auto CallingFunctionName = Data.CallExprParentMap[CE->first];
   return mergeFunctionCallImpl(Data, CalledFunctionName, CallingFunctionName, CE->second, CE->first);
 }
 
-std::optional<std::pair<VectorType<std::pair<StringType, CallInfoConstIterType>>, std::pair<StringType, StringType>>>
-mergeFunctionCallImpl(EquivClassContainer& Data, const StringType& CalledFunctionName,
-                      const StringType& CallingFunctionName, const CallInfo& CI, const StringType& CallExprUSR) {
-  VectorType<std::pair<StringType, CallInfoConstIterType>> Ret;
+std::optional<std::pair<VectorType<FunctionCallToMerge>, std::pair<StringType, StringType>>> mergeFunctionCallImpl(
+    EquivClassContainer& Data, const StringType& CalledFunctionName, const StringType& CallingFunctionName,
+    const CallInfo& CI, const StringType& CallExprUSR) {
+  VectorType<FunctionCallToMerge> Ret;
   assert(Data.FunctionInfoMap.find(CalledFunctionName) != Data.FunctionInfoMap.end());
   auto& CalledFunction = Data.FunctionInfoMap[CalledFunctionName];
 
@@ -1346,15 +1420,12 @@ mergeFunctionCallImpl(EquivClassContainer& Data, const StringType& CalledFunctio
                    << " Called from: " << CallingFunctionName << "\n";
     }
 
-    const auto ItL = Data.FindMap.find(Arg);
-    assert(ItL != Data.FindMap.end());
+    const auto IdL = Data.getObjectId(Arg);
     for (const auto& R : RHS) {
-      const auto ItR = Data.FindMap.find(R);
-
-      assert(ItR != Data.FindMap.end());
-      if (ItL->second != ItR->second) {
-        const auto Tmp = mergeRecurisve(Data, ItL->second, ItR->second);
-        Ret.insert(Ret.end(), Tmp.first.begin(), Tmp.first.end());
+      const auto IdR = Data.getObjectId(R);
+      if (!Data.inSameClass(IdL, IdR)) {
+        const auto Tmp = mergeRecurisve(Data, IdL, IdR);
+        Ret.insert(Ret.end(), Tmp.FunctionCalls.begin(), Tmp.FunctionCalls.end());
       }
     }
 
@@ -1365,14 +1436,12 @@ mergeFunctionCallImpl(EquivClassContainer& Data, const StringType& CalledFunctio
   const auto RHSObjects = CalledFunction.ReferencedInReturnStmts;
   if (!RHSObjects.empty()) {
     const ObjectName RetObj(CallExprUSR);
-    const auto ItL = Data.FindMap.find(RetObj.getStringRepr());
-    assert(ItL != Data.FindMap.end());
+    const auto IdL = Data.getObjectId(RetObj.getStringRepr());
     for (const auto& R : RHSObjects) {
-      const auto ItR = Data.FindMap.find(R);
-      assert(ItR != Data.FindMap.end());
-      if (ItL->second != ItR->second) {
-        const auto Tmp = mergeRecurisve(Data, ItL->second, ItR->second);
-        Ret.insert(Ret.end(), Tmp.first.begin(), Tmp.first.end());
+      const auto IdR = Data.getObjectId(R);
+      if (!Data.inSameClass(IdL, IdR)) {
+        const auto Tmp = mergeRecurisve(Data, IdL, IdR);
+        Ret.insert(Ret.end(), Tmp.FunctionCalls.begin(), Tmp.FunctionCalls.end());
       }
     }
   }
@@ -1380,76 +1449,56 @@ mergeFunctionCallImpl(EquivClassContainer& Data, const StringType& CalledFunctio
   return std::make_pair(Ret, std::make_pair(CallingFunctionName, CalledFunctionName));
 }
 
-void GetFunctionsToMerge(const EquivClassContainer& Data, VectorType<std::pair<StringType, CallInfoConstIterType>>& Ret,
-                         const EquivClass& E) {
-  VectorType<StringType> FunctionDecls;
-  VectorType<CallInfoConstIterType> UsedInCall;
-  for (const auto& Obj : E.Objects) {
-    if (Data.FunctionMap.find(Obj) != Data.FunctionMap.end()) {
-      FunctionDecls.emplace_back(Obj);
-    }
-    auto Calls = Data.ReferencedInCalls.find(Obj);
-    if (Calls != Data.ReferencedInCalls.end()) {
-      UsedInCall.insert(UsedInCall.end(), Calls->second.begin(), Calls->second.end());
-    }
-  }
-  for (auto F : FunctionDecls) {
-    for (auto C : UsedInCall) {
-      Ret.emplace_back(F, C);
-    }
-  }
+void GetFunctionsToMerge(const EquivClassContainer& Data, VectorType<FunctionCallToMerge>& Ret, ObjectId Rep) {
+  appendFunctionCalls(Data.FunctionObjects[Rep], Data.ReferencedInCalls[Rep], Ret);
 }
 
-MergeResult merge(EquivClassContainer& Data, EquivClassesIterator E1, EquivClassesIterator E2) {
-  assert(E1 != E2);
-  assert(!E1->Objects.empty());
-  assert(!E2->Objects.empty());
-
-  VectorType<std::pair<StringType, StringType>> ObjectsToMerge;
-  EquivClass E;
+MergeResult merge(EquivClassContainer& Data, ObjectId E1, ObjectId E2) {
+  const auto Rep1 = Data.find(E1);
+  const auto Rep2 = Data.find(E2);
+  assert(Rep1 != Rep2);
 
-  E.Objects.reserve(E1->Objects.size() + E2->Objects.size());
-  E.Objects.insert(E.Objects.end(), E1->Objects.begin(), E1->Objects.end());
-  E.Objects.insert(E.Objects.end(), E2->Objects.begin(), E2->Objects.end());
-  E.Prefixes = E1->Prefixes;
-  const VectorType<Prefix> Prefix2 = E2->Prefixes;
-  GetPrefixesToMerge(E, Prefix2, ObjectsToMerge);
-
-  const auto Iter = Data.EquivClasses.insert(Data.EquivClasses.end(), E);
-  for (const auto& Entry : E1->Objects) {
-    Data.FindMap[Entry] = Iter;
+  MergeResult Result;
+  // Merging the calls is idempotent, so only the calls that were not possible before are reported: the calls between
+  // the two classes, and the calls within a class if they were not reported by an earlier merge
+  if (!Data.CallsReported[Rep1]) {
+    GetFunctionsToMerge(Data, Result.FunctionCalls, Rep1);
   }
-  for (const auto& Entry : E2->Objects) {
-    Data.FindMap[Entry] = Iter;
+  if (!Data.CallsReported[Rep2]) {
+    GetFunctionsToMerge(Data, Result.FunctionCalls, Rep2);
   }
+  appendFunctionCalls(Data.FunctionObjects[Rep1], Data.ReferencedInCalls[Rep2], Result.FunctionCalls);
+  appendFunctionCalls(Data.FunctionObjects[Rep2], Data.ReferencedInCalls[Rep1], Result.FunctionCalls);
 
-  Data.EquivClasses.erase(E1);
-  Data.EquivClasses.erase(E2);
-
-  // Make sure the prefixes are unique
-  std::sort(E.Prefixes.begin(), E.Prefixes.end());
-  E.Prefixes.erase(std::unique(E.Prefixes.begin(), E.Prefixes.end()), E.Prefixes.end());
+  // Match the smaller prefix list against the larger one
+  auto Prefixes = std::move(Data.Prefixes[Rep1]);
+  auto Prefixes2 = std::move(Data.Prefixes[Rep2]);
+  Data.Prefixes[Rep1].clear();
+  Data.Prefixes[Rep2].clear();
+  if (Prefixes.size() < Prefixes2.size()) {
+    std::swap(Prefixes, Prefixes2);
+  }
+  GetPrefixesToMerge(Prefixes, Prefixes2, Result.ObjectsToMerge);
 
-  // We sadly can't reuse Iter here, as it can be invalidated by the merges of function calls
-  return {Data.FindMap.find(E.Objects.front()), ObjectsToMerge};
+  Result.Representative = Data.unite(Rep1, Rep2);
+  Data.Prefixes[Result.Representative] = std::move(Prefixes);
+  Data.CallsReported[Result.Representative] = true;
+  return Result;
 }
 
-void GetPrefixesToMerge(EquivClass& EquivClassToMergeInto, const VectorType<Prefix>& PrefixToMerge,
+void GetPrefixesToMerge(VectorType<Prefix>& PrefixesToMergeInto, const VectorType<Prefix>& PrefixToMerge,
                         VectorType<std::pair<StringType, StringType>>& ObjectsToMerge) {
   for (const auto& P : PrefixToMerge) {
-    const auto O1 = std::find_if(
-        EquivClassToMergeInto.Prefixes.begin(), EquivClassToMergeInto.Prefixes.end(), [P](const Prefix& foundPrefix) {
-          return (P.Object != foundPrefix.Object) &&
-                 ((P.Member.empty() && foundPrefix.Member.empty()) ||
-                  ((!P.Member.empty() && !foundPrefix.Member.empty()) && (P.Member == foundPrefix.Member)));
-        });
-    if (O1 != EquivClassToMergeInto.Prefixes.end()) {
-      ObjectsToMerge.emplace_back(P.Object, O1->Object);
+    const auto O1 = std::lower_bound(PrefixesToMergeInto.begin(), PrefixesToMergeInto.end(), P, lessByMember);
+    if (O1 != PrefixesToMergeInto.end() && O1->Member == P.Member) {
+      if (O1->Object != P.Object) {
+        ObjectsToMerge.emplace_back(P.Object, O1->Object);
+      }
     } else {
       // In the algorithm as it is in the paper this is only done for cases where we can't do a recursive merge, this
       // leads to lost prefixes but is valid, as the lost prefixes would point to the same equivalence class. We are
       // doing it the same way, to keep the prefix class small
-      EquivClassToMergeInto.Prefixes.push_back(P);
+      PrefixesToMergeInto.insert(O1, P);
     }
   }
 }
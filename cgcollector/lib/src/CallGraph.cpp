@@ -38,6 +38,7 @@
 
 #include "helper/common.h"
 
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <string>
@@ -1282,11 +1283,12 @@ CallGraphNode* CallGraph::getOrInsertNode(const Decl* F) {
 bool CallGraph::VisitFunctionDecl(clang::FunctionDecl* FD) {
   // We skip function template definitions, as their semantics is
   // only determined when they are instantiated.
-  static int count = 0;
+  // Shared by all translation units that are processed in parallel
+  static std::atomic<int> count{0};
   if (includeInGraph(FD) && (FD->isThisDeclarationADefinition() || includeUnusedDecls)) {
-    count++;
-    if (count % 100 == 0) {
-      std::cout << "Processing function nr " << count << std::endl;
+    const int current = ++count;
+    if (current % 100 == 0) {
+      std::cout << "Processing function nr " << current << std::endl;
     }
     // std::cout << "\n<< Visiting " << FD->getNameAsString() << " >>" << std::endl;
     // Add all blocks declared inside this function to the graph.
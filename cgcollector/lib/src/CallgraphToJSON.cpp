@@ -17,10 +17,10 @@ void convertCallGraphToJSON(const CallGraph& cg, nlohmann::json& j, const int ve
       FunctionNames callees;
 
       // We can get multiple mangled names, as Ctor/Dtor can encode dofferent things
-      auto mNames = getMangledName(f_decl);
+      const auto& mNames = getMangledName(f_decl);
       for (auto& it : *(it->getSecond())) {
         if (auto calleeDecl = llvm::dyn_cast<clang::FunctionDecl>(it->getDecl())) {
-          auto calleeNames = getMangledName(calleeDecl);
+          const auto& calleeNames = getMangledName(calleeDecl);
           //          for (const auto &n : calleeNames) {
           // std::cout << mNames.front() << " -- " << n << std::endl;
           //         }
@@ -36,12 +36,12 @@ void convertCallGraphToJSON(const CallGraph& cg, nlohmann::json& j, const int ve
       // overridden functions are collected during callgraph creation
       FunctionNames overriddenFunctions;
       for (auto f : it->getSecond()->getOverriddenMethods()) {
-        auto overriddenNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
+        const auto& overriddenNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
         overriddenFunctions.insert(std::begin(overriddenNames), std::end(overriddenNames));
       }
       FunctionNames overriddenBy;
       for (auto f : it->getSecond()->getOverriddenBy()) {
-        auto overridingNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
+        const auto& overridingNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
         overriddenBy.insert(std::begin(overridingNames), std::end(overridingNames));
       }
       // which functions do call the current function
@@ -51,7 +51,7 @@ void convertCallGraphToJSON(const CallGraph& cg, nlohmann::json& j, const int ve
         if (f) {
           // this check is not necessary because only function decls are add to the callgraph
           // if(auto fd = llvm::dyn_cast<clang::FunctionDecl>(f))
-          auto parentNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
+          const auto& parentNames = getMangledName(llvm::dyn_cast<clang::FunctionDecl>(f));
           callers.insert(std::begin(parentNames), std::end(parentNames));
         }
       }
@@ -85,3 +85,22 @@ void addMetaInformationToJSON(nlohmann::json& j, const std::string& metaInformat
     m.second->applyOnJSON(functionJSON, m.first, metaInformationName, mcgFormatVersion);
   }
 }
+
+void mergeTranslationUnitJSON(nlohmann::json& j, const nlohmann::json& tu, int mcgFormatVersion) {
+  if (tu.is_null()) {
+    return;
+  }
+  if (mcgFormatVersion == 2 && j.is_null()) {
+    attachFormatTwoHeader(j);
+  }
+
+  auto& wholeCG = mcgFormatVersion == 2 ? j["_CG"] : j;
+  const auto& tuCG = mcgFormatVersion == 2 ? tu.at("_CG") : tu;
+  for (const auto& [name, function] : tuCG.items()) {
+    if (!wholeCG.contains(name)) {
+      wholeCG[name] = function;
+    } else {
+      mergeFunctionJSON(wholeCG[name], function, mcgFormatVersion);
+    }
+  }
+}
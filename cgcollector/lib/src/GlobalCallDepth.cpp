@@ -1,96 +1,171 @@
 #include "GlobalCallDepth.h"
-#include <llvm/ADT/SmallSet.h>
 #include <llvm/ADT/StringMap.h>
-#include <queue>
-#include <set>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
-int getCallDepth(const std::string& entry, const llvm::StringMap<llvm::StringMap<int>>& callDepths,
-                 const llvm::StringMap<int>& localLoopDepth, llvm::StringMap<int>& globalLoopDepth,
-                 llvm::StringMap<bool>& visited) {
-  // First mark ourselves as visited, to infinite loops
-  visited.insert_or_assign(entry, true);
-  int maxChildDepth = 0;
-  const auto childrenit = callDepths.find(entry);
-  assert(childrenit != callDepths.end());
-  const auto children = childrenit->second;
-
-  for (const auto& child : children) {
-    if (visited.find(child.first()) == visited.end()) {
-      maxChildDepth = std::max(maxChildDepth, child.second + getCallDepth(std::string(child.first()), callDepths,
-                                                                          localLoopDepth, globalLoopDepth, visited));
+namespace {
+
+/**
+ * The call graph with dense node indices. Edges are weighted with the loop depth of the call site.
+ */
+struct DepthGraph {
+  std::vector<int> localLoopDepth;
+  std::vector<std::vector<std::pair<unsigned, int>>> callees;
+  llvm::StringMap<unsigned> index;
+
+  unsigned getOrInsert(llvm::StringRef name) {
+    const auto [it, inserted] = index.try_emplace(name, localLoopDepth.size());
+    if (inserted) {
+      localLoopDepth.push_back(0);
+      callees.emplace_back();
     }
+    return it->second;
   }
-  // Remove mark
-  visited.erase(entry);
-  const int loopDepth = std::max(maxChildDepth, localLoopDepth.lookup(entry));
-  auto globalLDIt = globalLoopDepth.find(entry);
-  if (globalLDIt == globalLoopDepth.end()) {
-    globalLoopDepth.insert({entry, loopDepth});
-  } else {
-    globalLDIt->second = std::max(globalLDIt->second, loopDepth);
+};
+
+constexpr unsigned Unvisited = std::numeric_limits<unsigned>::max();
+
+/**
+ * Tarjan's algorithm from the given entry points, iteratively to not be limited by the stack size. The strongly
+ * connected components are completed in reverse topological order, i.e., all components reachable from a component are
+ * completed before it, so the longest path depth of each component is computed on completion.
+ * @return The global loop depth per node, -1 for nodes not reachable from the entry points
+ */
+std::vector<int> computeGlobalLoopDepths(const DepthGraph& graph, const std::vector<unsigned>& entryPoints) {
+  const auto numNodes = graph.localLoopDepth.size();
+  std::vector<unsigned> order(numNodes, Unvisited);
+  std::vector<unsigned> lowLink(numNodes, 0);
+  std::vector<unsigned> component(numNodes, Unvisited);
+  std::vector<int> componentDepth;
+  std::vector<unsigned> sccStack;
+  std::vector<std::pair<unsigned, std::size_t>> callStack;  // node and index of its next callee
+  unsigned nextOrder = 0;
+
+  for (const auto entry : entryPoints) {
+    if (order[entry] != Unvisited) {
+      continue;
+    }
+    order[entry] = lowLink[entry] = nextOrder++;
+    sccStack.push_back(entry);
+    callStack.emplace_back(entry, 0);
+
+    while (!callStack.empty()) {
+      auto& [node, nextCallee] = callStack.back();
+      if (nextCallee < graph.callees[node].size()) {
+        const auto callee = graph.callees[node][nextCallee++].first;
+        if (order[callee] == Unvisited) {
+          order[callee] = lowLink[callee] = nextOrder++;
+          sccStack.push_back(callee);
+          callStack.emplace_back(callee, 0);
+        } else if (component[callee] == Unvisited) {
+          // On the stack, i.e., part of the current recursion
+          lowLink[node] = std::min(lowLink[node], order[callee]);
+        }
+        continue;
+      }
+
+      const auto finished = node;
+      callStack.pop_back();
+      if (!callStack.empty()) {
+        const auto caller = callStack.back().first;
+        lowLink[caller] = std::min(lowLink[caller], lowLink[finished]);
+      }
+      if (lowLink[finished] != order[finished]) {
+        continue;
+      }
+
+      // finished is the root of a component
+      const auto id = static_cast<unsigned>(componentDepth.size());
+      const auto firstMember = std::prev(std::find(sccStack.rbegin(), sccStack.rend(), finished).base());
+      for (auto it = firstMember; it != sccStack.end(); ++it) {
+        component[*it] = id;
+      }
+      // The depth of a recursion is unbounded, calls within the component add the local loop depth of the callee as a
+      // lower bound
+      int depth = 0;
+      for (auto it = firstMember; it != sccStack.end(); ++it) {
+        depth = std::max(depth, graph.localLoopDepth[*it]);
+        for (const auto& [callee, callDepth] : graph.callees[*it]) {
+          const auto calleeDepth =
+              component[callee] == id ? graph.localLoopDepth[callee] : componentDepth[component[callee]];
+          depth = std::max(depth, callDepth + calleeDepth);
+        }
+      }
+      componentDepth.push_back(depth);
+      sccStack.erase(firstMember, sccStack.end());
+    }
+  }
+
+  std::vector<int> globalLoopDepth(numNodes, -1);
+  for (std::size_t node = 0; node < numNodes; ++node) {
+    if (component[node] != Unvisited) {
+      globalLoopDepth[node] = componentDepth[component[node]];
+    }
   }
-  return loopDepth;
+  return globalLoopDepth;
 }
 
+}  // namespace
+
 void calculateGlobalCallDepth(nlohmann::json& j, bool useOnlyMainEntry) {
   // This only works for metadata version 2
-  using MapT = llvm::StringMap<int>;
-  llvm::StringMap<MapT> callDepths;
-  llvm::StringMap<int> localLoopDepth;
-  llvm::StringMap<int> globalLoopDepth;
-  llvm::StringMap<bool> visited;
+  DepthGraph graph;
 
   auto& cg = j["_CG"];
   // Init the local call depths and the call graph
   for (const auto& [key, val] : cg.items()) {
     const auto& metaval = val["meta"];
     assert(metaval.count("loopDepth") == 1);
-    [[maybe_unused]] const bool inserted = localLoopDepth.insert({key, metaval["loopDepth"]}).second;
-    assert(inserted);
-    MapT called;
+    const auto node = graph.getOrInsert(key);
+    graph.localLoopDepth[node] = metaval["loopDepth"].get<int>();
+
+    llvm::StringMap<int> called;
     assert(val.count("callees") == 1);
     for (const auto& c : val["callees"]) {
       called.insert({c.get<std::string>(), 0});
     }
     assert(metaval.count("loopCallDepth") == 1);
     for (const auto& [calledFunction, callDepth] : metaval["loopCallDepth"].items()) {
-      called[calledFunction] = callDepth;
+      called[calledFunction] = callDepth.get<int>();
+    }
+    for (const auto& c : called) {
+      const auto callee = graph.getOrInsert(c.first());
+      graph.callees[node].emplace_back(callee, c.second);
     }
-    assert(callDepths.count(key) == 0);
-    callDepths.insert_or_assign(key, called);
   }
 
-  std::vector<std::string> entryPoints;
+  std::vector<unsigned> entryPoints;
 
   // Find entry points
   if (!useOnlyMainEntry) {
-    llvm::StringMap<bool> called;
-    for (const auto& caller : callDepths) {
-      called.insert({caller.first(), false});
-      for (const auto& callee : caller.second) {
-        if (callee.first() != caller.first()) {
-          called.insert_or_assign(callee.first(), true);
+    std::vector<bool> called(graph.localLoopDepth.size(), false);
+    for (unsigned caller = 0; caller < graph.callees.size(); ++caller) {
+      for (const auto& callee : graph.callees[caller]) {
+        if (callee.first != caller) {
+          called[callee.first] = true;
         }
       }
     }
-    for (const auto& f : called) {
-      if (!f.second) {
-        entryPoints.emplace_back(f.first());
+    for (unsigned node = 0; node < called.size(); ++node) {
+      if (!called[node]) {
+        entryPoints.push_back(node);
       }
     }
   } else {
-    if (callDepths.find("main") != callDepths.end()) {
-      entryPoints.emplace_back("main");
+    const auto mainIt = graph.index.find("main");
+    if (mainIt != graph.index.end()) {
+      entryPoints.push_back(mainIt->second);
     }
   }
 
-  for (const auto& entry : entryPoints) {
-    globalLoopDepth.insert_or_assign(entry, getCallDepth(entry, callDepths, localLoopDepth, globalLoopDepth, visited));
-  }
+  const auto globalLoopDepth = computeGlobalLoopDepths(graph, entryPoints);
 
   for (auto& [key, val] : cg.items()) {
-    const auto gcd = globalLoopDepth.lookup(key);
+    const auto gcd = globalLoopDepth[graph.index.lookup(key)];
     val["meta"]["globalLoopDepth"] = std::max(gcd, val["meta"]["loopDepth"].get<int>());
   }
 }
@@ -3,6 +3,7 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <utility>
 
 FuncMapT::mapped_type& getOrInsert(const std::string& function, FuncMapT& functions) {
   if (functions.find(function) != functions.end()) {
@@ -227,3 +228,90 @@ nlohmann::json buildFromJSONv2(FuncMapT& functionMap, const std::string& filenam
   // std::cout << "Filename: " << filename << "\n" << j << std::endl;
   return j;
 }
+
+namespace {
+
+void uniteNames(nlohmann::json& target, const nlohmann::json& source) {
+  auto names = target.is_null() ? FunctionNames{} : target.get<FunctionNames>();
+  for (const auto& n : source) {
+    names.insert(n.get<std::string>());
+  }
+  target = names;
+}
+
+void mergeEstimateCallCount(nlohmann::json& c, const nlohmann::json& v) {
+  auto& cCodeRegions = c["codeRegions"];
+  for (const auto& [regionName, region] : v["codeRegions"].items()) {
+    if (!cCodeRegions.contains(regionName)) {
+      cCodeRegions[regionName] = region;
+    } else {
+      uniteNames(cCodeRegions[regionName]["functions"], region["functions"]);
+    }
+  }
+
+  auto& cCalls = c["calls"];
+  for (const auto& [functionName, functionInfo] : v["calls"].items()) {
+    if (!cCalls.contains(functionName)) {
+      cCalls[functionName] = functionInfo;
+    } else {
+      auto calls = cCalls[functionName].get<std::set<std::pair<double, std::string>>>();
+      const auto otherCalls = functionInfo.get<std::set<std::pair<double, std::string>>>();
+      calls.insert(otherCalls.begin(), otherCalls.end());
+      cCalls[functionName] = calls;
+    }
+  }
+}
+
+void mergeLoopCallDepth(nlohmann::json& c, const nlohmann::json& v) {
+  for (const auto& [calledFunction, depth] : v.items()) {
+    if (!c.contains(calledFunction) || c[calledFunction].get<int>() < depth.get<int>()) {
+      c[calledFunction] = depth;
+    }
+  }
+}
+
+}  // namespace
+
+void mergeFunctionJSON(nlohmann::json& c, const nlohmann::json& v, int mcgFormatVersion) {
+  static const std::set<std::string> structureFieldsV1{"callees",      "parents", "overriddenFunctions", "overriddenBy",
+                                                       "doesOverride", "hasBody", "isVirtual"};
+  static const std::set<std::string> structureFieldsV2{"callees",      "callers", "overrides", "overriddenBy",
+                                                       "doesOverride", "hasBody", "isVirtual"};
+  const auto& structureFields = mcgFormatVersion == 2 ? structureFieldsV2 : structureFieldsV1;
+  const bool cHasBody = c["hasBody"].get<bool>();
+  const bool vHasBody = v["hasBody"].get<bool>();
+
+  for (const auto& field : structureFields) {
+    if (field == "isVirtual" || field == "doesOverride" || field == "hasBody") {
+      c[field] = c[field].get<bool>() || v[field].get<bool>();
+    } else {
+      uniteNames(c[field], v[field]);
+    }
+  }
+
+  // Format version 1 stores the meta information next to the structure fields, version 2 in a separate object
+  if (mcgFormatVersion == 2 && !v.contains("meta")) {
+    return;
+  }
+  auto& cMeta = mcgFormatVersion == 2 ? c["meta"] : c;
+  const auto& vMeta = mcgFormatVersion == 2 ? v["meta"] : v;
+  for (const auto& [key, value] : vMeta.items()) {
+    if (mcgFormatVersion == 1 && structureFields.count(key) > 0) {
+      continue;
+    }
+    if (!cMeta.contains(key)) {
+      cMeta[key] = value;
+    } else if (key == "estimateCallCount") {
+      mergeEstimateCallCount(cMeta[key], value);
+    } else if (key == "loopCallDepth") {
+      mergeLoopCallDepth(cMeta[key], value);
+    } else if (key == "numStatements" && cHasBody && vHasBody) {
+      // The number of statements should not differ, if it does all bodies are counted
+      if (cMeta[key].get<int>() != value.get<int>()) {
+        cMeta[key] = cMeta[key].get<int>() + value.get<int>();
+      }
+    } else if (!cHasBody && vHasBody) {
+      cMeta[key] = value;
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::size_t getNumWorkers(std::size_t numItems, unsigned jobs) {
+  const unsigned threads = jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : jobs;
+  return std::min<std::size_t>(threads, numItems);
+}
+
+void runWorkers(std::size_t numWorkers, const std::function<void(std::size_t)>& worker) {
+  if (numWorkers <= 1) {
+    if (numWorkers == 1) {
+      worker(0);
+    }
+    return;
+  }
+
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  threads.reserve(numWorkers);
+  for (std::size_t w = 0; w < numWorkers; ++w) {
+    threads.emplace_back([&, w]() {
+      // An exception escaping a thread would terminate the program
+      try {
+        worker(w);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void parallelFor(std::size_t numItems, const std::function<void(std::size_t)>& fn, unsigned jobs) {
+  std::atomic<std::size_t> nextItem{0};
+  runWorkers(getNumWorkers(numItems, jobs), [&](std::size_t) {
+    for (auto i = nextItem++; i < numItems; i = nextItem++) {
+      fn(i);
+    }
+  });
+}
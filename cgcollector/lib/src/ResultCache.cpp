@@ -0,0 +1,111 @@
+#include "ResultCache.h"
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <fstream>
+#include <utility>
+
+ResultCache::ResultCache(std::string cacheDir) : cacheDir(std::move(cacheDir)) {}
+
+std::string ResultCache::hashContent(llvm::StringRef content) {
+  llvm::MD5 hash;
+  hash.update(content);
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  return std::string(result.digest().str());
+}
+
+std::string ResultCache::hashFile(const std::string& path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return "";
+  }
+  return hashContent((*buffer)->getBuffer());
+}
+
+std::string ResultCache::computeKey(const std::string& sourceFile, const std::string& configuration) {
+  const auto sourceHash = hashFile(sourceFile);
+  if (sourceHash.empty()) {
+    return "";
+  }
+  // The separators keep the concatenation unambiguous
+  return hashContent(configuration + '\0' + sourceFile + '\0' + sourceHash);
+}
+
+std::string ResultCache::getEntryPath(const std::string& key) const {
+  llvm::SmallString<256> path(cacheDir);
+  llvm::sys::path::append(path, key + ".json");
+  return std::string(path.str());
+}
+
+std::optional<nlohmann::json> ResultCache::lookup(const std::string& key) const {
+  std::ifstream in(getEntryPath(key));
+  if (!in) {
+    return std::nullopt;
+  }
+
+  nlohmann::json entry;
+  try {
+    in >> entry;
+    for (const auto& dependency : entry.at("dependencies").items()) {
+      if (hashFile(dependency.key()) != dependency.value().get<std::string>()) {
+        return std::nullopt;
+      }
+    }
+    for (const auto& missingFile : entry.at("missing")) {
+      if (llvm::sys::fs::exists(missingFile.get<std::string>())) {
+        return std::nullopt;
+      }
+    }
+    return std::move(entry.at("result"));
+  } catch (const nlohmann::json::exception&) {
+    // A damaged entry is treated as missing and overwritten by the next store
+    return std::nullopt;
+  }
+}
+
+bool ResultCache::store(const std::string& key, const std::vector<std::string>& dependencies,
+                        const std::vector<std::string>& missingFiles, const nlohmann::json& result) const {
+  nlohmann::json entry;
+  entry["dependencies"] = nlohmann::json::object();
+  for (const auto& dependency : dependencies) {
+    const auto hash = hashFile(dependency);
+    if (hash.empty()) {
+      // The entry could never be validated
+      return false;
+    }
+    entry["dependencies"][dependency] = hash;
+  }
+  entry["missing"] = missingFiles;
+  entry["result"] = result;
+
+  if (llvm::sys::fs::create_directories(cacheDir)) {
+    return false;
+  }
+
+  // Write to a unique file and rename it, so concurrent readers never see a partial entry
+  int fd = -1;
+  llvm::SmallString<256> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(getEntryPath(key) + "-%%%%%%.tmp", fd, tmpPath)) {
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+    out << entry.dump();
+    out.flush();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(tmpPath, getEntryPath(key))) {
+    llvm::sys::fs::remove(tmpPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,229 @@
+#include "TranslationUnitCollector.h"
+
+#include "AliasAnalysis.h"
+#include "CallgraphToJSON.h"
+
+#include <clang/AST/ASTConsumer.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+
+#include <cassert>
+#include <set>
+#include <utility>
+
+namespace {
+
+typedef std::vector<MetaCollector*> MetaCollectorVector;
+
+class CallGraphCollectorConsumer : public clang::ASTConsumer {
+ public:
+  CallGraphCollectorConsumer(MetaCollectorVector mcs, nlohmann::json& j, const CollectorOptions& options)
+      : _mcs(mcs), _json(j), _options(options) {}
+
+  virtual void HandleTranslationUnit(clang::ASTContext& Context) {
+    callGraph.setCaptureCtorsDtors(_options.captureCtorsDtors);
+    callGraph.setInferCtorDtorCalls(_options.inferCtorDtorCalls);
+    callGraph.setIncludeDecl(_options.includeUnusedDecl);
+    if (!_options.disableClassicCGConstruction) {
+      callGraph.TraverseDecl(Context.getTranslationUnitDecl());
+    }
+    nlohmann::json AliasAnalysisMetadata;
+    if (_options.enableAA) {
+      calculateAliasInfo(Context.getTranslationUnitDecl(), &callGraph, AliasAnalysisMetadata,
+                         _options.metacgFormatVersion, _options.captureCtorsDtors, _options.captureStackCtorsDtors);
+    }
+
+    MetaCollector::calculateForAll(callGraph, _mcs);
+
+    convertCallGraphToJSON(callGraph, _json, _options.metacgFormatVersion);
+    if (_options.enableAA && _options.metacgFormatVersion >= 2) {
+      _json["PointerEquivalenceData"] = AliasAnalysisMetadata;
+    }
+  }
+
+ private:
+  CallGraph callGraph;
+  MetaCollectorVector _mcs;
+  nlohmann::json& _json;
+  const CollectorOptions& _options;
+};
+
+/**
+ * Records the include closure of a translation unit, including system headers
+ */
+class IncludeClosureCollector : public clang::DependencyCollector {
+ public:
+  bool needSystemDependencies() override { return true; }
+};
+
+/**
+ * Records the paths that are looked up in the file system but do not exist
+ */
+class MissingFileRecorder : public llvm::vfs::ProxyFileSystem {
+ public:
+  explicit MissingFileRecorder(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fs) : ProxyFileSystem(std::move(fs)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+    auto result = ProxyFileSystem::status(path);
+    record(path, result.getError());
+    return result;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(const llvm::Twine& path) override {
+    auto result = ProxyFileSystem::openFileForRead(path);
+    record(path, result.getError());
+    return result;
+  }
+
+  const std::set<std::string>& getMissingFiles() const { return missingFiles; }
+
+ private:
+  void record(const llvm::Twine& path, std::error_code error) {
+    if (error != std::errc::no_such_file_or_directory) {
+      return;
+    }
+    // Relative paths are relative to the working directory of the compile command
+    llvm::SmallString<256> absolutePath;
+    path.toVector(absolutePath);
+    makeAbsolute(absolutePath);
+    llvm::sys::path::remove_dots(absolutePath, true);
+    missingFiles.emplace(absolutePath.str());
+  }
+
+  std::set<std::string> missingFiles;
+};
+
+class CallGraphCollectorFactory : clang::ASTFrontendAction {
+ public:
+  CallGraphCollectorFactory(MetaCollectorVector mcs, nlohmann::json& j, const CollectorOptions& options,
+                            std::shared_ptr<IncludeClosureCollector> includes = nullptr)
+      : _mcs(mcs), _json(j), _options(options), _includes(std::move(includes)) {}
+
+  std::unique_ptr<clang::ASTConsumer> newASTConsumer() {
+    return std::unique_ptr<clang::ASTConsumer>(new CallGraphCollectorConsumer(_mcs, _json, _options));
+  }
+
+  std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compiler,
+                                                        [[maybe_unused]] llvm::StringRef sr) {
+    // The main file is entered only after the consumer is created, so the collector sees all includes
+    if (_includes) {
+      _includes->attachToPreprocessor(compiler.getPreprocessor());
+    }
+    return std::unique_ptr<clang::ASTConsumer>(new CallGraphCollectorConsumer(_mcs, _json, _options));
+  }
+
+ private:
+  MetaCollectorVector _mcs;
+  nlohmann::json& _json;
+  const CollectorOptions& _options;
+  std::shared_ptr<IncludeClosureCollector> _includes;
+};
+
+}  // namespace
+
+MetaCollectorList createMetaCollectors(const CollectorOptions& options) {
+  MetaCollectorList mcs;
+  mcs.push_back(std::make_unique<NumberOfStatementsCollector>());
+  mcs.push_back(std::make_unique<FilePropertyCollector>());
+  mcs.push_back(std::make_unique<CodeStatisticsCollector>());
+  mcs.push_back(std::make_unique<MallocVariableCollector>());
+  // mcs.push_back(std::make_unique<UniqueTypeCollector>());
+  if (options.metacgFormatVersion > 1) {
+    mcs.push_back(std::make_unique<NumConditionalBranchCollector>());
+    mcs.push_back(std::make_unique<NumOperationsCollector>());
+    mcs.push_back(std::make_unique<LoopDepthCollector>());
+    mcs.push_back(std::make_unique<GlobalLoopDepthCollector>());
+    mcs.push_back(std::make_unique<InlineCollector>());
+    mcs.push_back(std::make_unique<EstimateCallCountCollector>(options.loopCountEstimation,
+                                                                options.conditionTrueChance,
+                                                                1.0 - options.conditionTrueChance,
+                                                                options.exceptionChance));
+  }
+  return mcs;
+}
+
+std::string getOptionsConfiguration(const CollectorOptions& options) {
+  return "metacg-format-version=" + std::to_string(options.metacgFormatVersion) +
+         "\nenable-AA=" + std::to_string(options.enableAA) +
+         "\ncapture-ctors-dtors=" + std::to_string(options.captureCtorsDtors) +
+         "\ncapture-stack-ctors-dtors=" + std::to_string(options.captureStackCtorsDtors) +
+         "\nno-infer-ctor-dtor-calls=" + std::to_string(!options.inferCtorDtorCalls) +
+         "\ninclude-unused-decl=" + std::to_string(options.includeUnusedDecl) +
+         "\ndisable-classic-cgc=" + std::to_string(options.disableClassicCGConstruction) +
+         "\ncce-loop-count=" + std::to_string(options.loopCountEstimation) +
+         "\ncce-condition-true-chance=" + std::to_string(options.conditionTrueChance) +
+         "\ncce-exception-chance=" + std::to_string(options.exceptionChance);
+}
+
+std::string getCompileDirectory(const clang::tooling::CompilationDatabase& compilations, const std::string& sourceFile) {
+  const auto commands = compilations.getCompileCommands(sourceFile);
+  return commands.empty() ? "" : commands.front().Directory;
+}
+
+CollectorWorkspace::CollectorWorkspace(std::string directory)
+    // The tools change the working directory of their file system, so it must not be shared between workers
+    : directory(std::move(directory)),
+      fileSystem(llvm::vfs::createPhysicalFileSystem().release()),
+      fileManager(new clang::FileManager(clang::FileSystemOptions(), fileSystem)),
+      pchContainerOps(std::make_shared<clang::PCHContainerOperations>()) {
+  fileManager->getFileSystemOpts().WorkingDir = this->directory;
+}
+
+int collectTranslationUnit(const clang::tooling::CompilationDatabase& compilations, const std::string& sourceFile,
+                           const CollectorOptions& options, nlohmann::json& j,
+                           TranslationUnitDependencies* dependencies, CollectorWorkspace* workspace) {
+  assert(!(dependencies && workspace) && "The dependencies of a translation unit cannot be recorded in a workspace");
+  const auto directory = getCompileDirectory(compilations, sourceFile);
+
+  std::unique_ptr<clang::tooling::ClangTool> CT;
+  llvm::IntrusiveRefCntPtr<MissingFileRecorder> missingFiles;
+  if (workspace) {
+    assert(workspace->directory == directory && "The workspace belongs to another compile directory");
+    CT = std::make_unique<clang::tooling::ClangTool>(compilations, std::vector<std::string>{sourceFile},
+                                                     workspace->pchContainerOps, workspace->fileSystem,
+                                                     workspace->fileManager);
+  } else {
+    // A separate file system per tool, as the tools change the working directory of their file system
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fs(llvm::vfs::createPhysicalFileSystem().release());
+    if (dependencies) {
+      missingFiles = new MissingFileRecorder(fs);
+      fs = missingFiles;
+    }
+    CT = std::make_unique<clang::tooling::ClangTool>(compilations, std::vector<std::string>{sourceFile},
+                                                     std::make_shared<clang::PCHContainerOperations>(), fs);
+  }
+
+  const auto collectors = createMetaCollectors(options);
+  MetaCollectorVector mcs;
+  for (const auto& mc : collectors) {
+    mcs.push_back(mc.get());
+  }
+
+  const auto includes = dependencies ? std::make_shared<IncludeClosureCollector>() : nullptr;
+  const int ret = CT->run(clang::tooling::newFrontendActionFactory<CallGraphCollectorFactory>(
+                              new CallGraphCollectorFactory(mcs, j, options, includes))
+                              .get());
+
+  for (const auto mc : mcs) {
+    addMetaInformationToJSON(j, mc->getName(), mc->getMetaInformation(), options.metacgFormatVersion);
+  }
+
+  if (includes) {
+    // Included files are spelled relative to the working directory of the compile command
+    for (const auto& dependency : includes->getDependencies()) {
+      llvm::SmallString<256> path(dependency);
+      if (!directory.empty()) {
+        llvm::sys::fs::make_absolute(directory, path);
+      }
+      dependencies->includedFiles.emplace_back(path.str());
+    }
+  }
+  if (missingFiles) {
+    dependencies->missingFiles.assign(missingFiles->getMissingFiles().begin(), missingFiles->getMissingFiles().end());
+  }
+  return ret;
+}
@@ -125,39 +125,107 @@ int getNumStmtsInDoStmt(clang::DoStmt* ds) {
   return numStmts;
 }
 
-class NumConditionalBranchVisitor : public clang::RecursiveASTVisitor<NumConditionalBranchVisitor> {
+namespace {
+
+/**
+ * Calls all Visit* methods of visitor that apply to the dynamic class of stmt, exactly as a RecursiveASTVisitor does
+ * when its traversal reaches stmt.
+ */
+template <typename Visitor>
+void walkUpFrom(Visitor& visitor, clang::Stmt* stmt) {
+  switch (stmt->getStmtClass()) {
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT)                                     \
+  case clang::Stmt::CLASS##Class:                               \
+    visitor.WalkUpFrom##CLASS(llvm::cast<clang::CLASS>(stmt)); \
+    break;
+#include "clang/AST/StmtNodes.inc"
+    default:
+      break;
+  }
+}
+
+/**
+ * The shared traversal of traverseFunctionBody
+ */
+class FusedBodyVisitor : public clang::RecursiveASTVisitor<FusedBodyVisitor> {
+ private:
+  llvm::ArrayRef<BodyStmtListener*> listeners;
+  int cur_loop_depth = 0;
+
  public:
-  int count = 0;
+  explicit FusedBodyVisitor(llvm::ArrayRef<BodyStmtListener*> listeners) : listeners(listeners) {}
 
   bool shouldVisitTemplateInstantiations() const { return true; }
 
   bool VisitStmt(clang::Stmt* stmt) {
-    switch (stmt->getStmtClass()) {
-      case clang::Stmt::IfStmtClass:
-      case clang::Stmt::ConditionalOperatorClass:        // ? operator
-      case clang::Stmt::BinaryConditionalOperatorClass:  // GNU extension
-      case clang::Stmt::WhileStmtClass:
-      case clang::Stmt::DoStmtClass:
-      case clang::Stmt::ForStmtClass:
-      case clang::Stmt::CXXForRangeStmtClass:
-      case clang::Stmt::SwitchStmtClass:
-        count += 1;
-        break;
-      default:
-        break;
+    for (const auto listener : listeners) {
+      listener->visitStmt(stmt, cur_loop_depth);
     }
     return true;
   }
+
+  bool TraverseDoStmt(clang::DoStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
+    cur_loop_depth++;
+    const bool result = RecursiveASTVisitor::TraverseDoStmt(s, nullptr);
+    cur_loop_depth--;
+    return result;
+  }
+
+  bool TraverseWhileStmt(clang::WhileStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
+    cur_loop_depth++;
+    const bool result = RecursiveASTVisitor::TraverseWhileStmt(s, nullptr);
+    cur_loop_depth--;
+    return result;
+  }
+
+  bool TraverseForStmt(clang::ForStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
+    cur_loop_depth++;
+    const bool result = RecursiveASTVisitor::TraverseForStmt(s, nullptr);
+    cur_loop_depth--;
+    return result;
+  }
+
+  bool TraverseCXXForRangeStmt(clang::CXXForRangeStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
+    cur_loop_depth++;
+    const bool result = RecursiveASTVisitor::TraverseCXXForRangeStmt(s, nullptr);
+    cur_loop_depth--;
+    return result;
+  }
 };
 
-int getNumConditionalBranchesInStmt(clang::Stmt* s) {
-  if (s == nullptr) {
-    return 0;
+}  // namespace
+
+void traverseFunctionBody(clang::Stmt* body, llvm::ArrayRef<BodyStmtListener*> listeners) {
+  if (body == nullptr || listeners.empty()) {
+    return;
   }
-  NumConditionalBranchVisitor visitor;
-  visitor.TraverseStmt(s);
-  // visitor.visitStmt(s);
-  return visitor.count;
+  FusedBodyVisitor visitor(listeners);
+  visitor.TraverseStmt(body);
+}
+
+void NumConditionalBranchListener::visitStmt(clang::Stmt* stmt, [[maybe_unused]] int loopDepth) {
+  switch (stmt->getStmtClass()) {
+    case clang::Stmt::IfStmtClass:
+    case clang::Stmt::ConditionalOperatorClass:        // ? operator
+    case clang::Stmt::BinaryConditionalOperatorClass:  // GNU extension
+    case clang::Stmt::WhileStmtClass:
+    case clang::Stmt::DoStmtClass:
+    case clang::Stmt::ForStmtClass:
+    case clang::Stmt::CXXForRangeStmtClass:
+    case clang::Stmt::SwitchStmtClass:
+      count += 1;
+      break;
+    default:
+      break;
+  }
+}
+
+int getNumConditionalBranchesInStmt(clang::Stmt* s) {
+  NumConditionalBranchListener counter;
+  BodyStmtListener* listener = &counter;
+  traverseFunctionBody(s, listener);
+  return counter.count;
 }
 
 // Operations Counting
@@ -623,122 +691,56 @@ class NumOperationsVisitor : public clang::RecursiveASTVisitor<NumOperationsVisi
   }
 };
 
-NumOperations getNumOperationsInStmt(clang::Stmt* s) {
-  if (s == nullptr) {
-    return {};
-  }
-  NumOperations result;
-  NumOperationsVisitor visitor;
-  visitor.TraverseStmt(s);
-  result.numberOfIntOps = visitor.numIntOps;
-  result.numberOfFloatOps = visitor.numFloatOps;
-  result.numberOfControlFlowOps = visitor.numControlFlowOps;
-  result.numberOfMemoryAccesses = visitor.numMemoryAccesses;
-  return result;
-}
-
-class LoopDepthVisitor : public clang::RecursiveASTVisitor<LoopDepthVisitor> {
- private:
-  int cur_loop_depth = 0;
+NumOperationsListener::NumOperationsListener() : visitor(std::make_unique<NumOperationsVisitor>()) {}
 
- public:
-  int maxdepth = 0;
+NumOperationsListener::~NumOperationsListener() = default;
 
-  bool shouldVisitTemplateInstantiations() const { return true; }
+void NumOperationsListener::visitStmt(clang::Stmt* stmt, [[maybe_unused]] int loopDepth) {
+  // The counting visitor is not traversing itself, it only receives the Visit* calls for the statement
+  walkUpFrom(*visitor, stmt);
+}
 
-  bool TraverseDoStmt(clang::DoStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    maxdepth = std::max(maxdepth, cur_loop_depth);
-    const bool result = RecursiveASTVisitor::TraverseDoStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
+NumOperations NumOperationsListener::getResult() const {
+  NumOperations result;
+  result.numberOfIntOps = visitor->numIntOps;
+  result.numberOfFloatOps = visitor->numFloatOps;
+  result.numberOfControlFlowOps = visitor->numControlFlowOps;
+  result.numberOfMemoryAccesses = visitor->numMemoryAccesses;
+  return result;
+}
 
-  bool TraverseWhileStmt(clang::WhileStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    maxdepth = std::max(maxdepth, cur_loop_depth);
-    const bool result = RecursiveASTVisitor::TraverseWhileStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
+void NumOperationsListener::reset() { visitor = std::make_unique<NumOperationsVisitor>(); }
 
-  bool TraverseForStmt(clang::ForStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    maxdepth = std::max(maxdepth, cur_loop_depth);
-    const bool result = RecursiveASTVisitor::TraverseForStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
+NumOperations getNumOperationsInStmt(clang::Stmt* s) {
+  NumOperationsListener counter;
+  BodyStmtListener* listener = &counter;
+  traverseFunctionBody(s, listener);
+  return counter.getResult();
+}
 
-  bool TraverseCXXForRangeStmt(clang::CXXForRangeStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    maxdepth = std::max(maxdepth, cur_loop_depth);
-    const bool result = RecursiveASTVisitor::TraverseCXXForRangeStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
-};
+void LoopDepthListener::visitStmt([[maybe_unused]] clang::Stmt* stmt, int loopDepth) {
+  maxDepth = std::max(maxDepth, loopDepth);
+}
 
 int getLoopDepthInStmt(clang::Stmt* s) {
-  if (s == nullptr) {
-    return 0;
-  }
-  LoopDepthVisitor visitor;
-  visitor.TraverseStmt(s);
-  return visitor.maxdepth;
+  LoopDepthListener counter;
+  BodyStmtListener* listener = &counter;
+  traverseFunctionBody(s, listener);
+  return counter.maxDepth;
 }
 
-class CallDepthVisitor : public clang::RecursiveASTVisitor<CallDepthVisitor> {
- private:
-  int cur_loop_depth = 0;
-
- public:
-  llvm::SmallDenseMap<const clang::CallExpr*, int, 16> calls;
-
-  bool shouldVisitTemplateInstantiations() const { return true; }
-
-  bool TraverseDoStmt(clang::DoStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    const bool result = RecursiveASTVisitor::TraverseDoStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
-
-  bool TraverseWhileStmt(clang::WhileStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    const bool result = RecursiveASTVisitor::TraverseWhileStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
-
-  bool TraverseForStmt(clang::ForStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    const bool result = RecursiveASTVisitor::TraverseForStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
-
-  bool TraverseCXXForRangeStmt(clang::CXXForRangeStmt* s, [[maybe_unused]] DataRecursionQueue* q = nullptr) {
-    cur_loop_depth++;
-    const bool result = RecursiveASTVisitor::TraverseCXXForRangeStmt(s, nullptr);
-    cur_loop_depth--;
-    return result;
-  }
-
-  bool VisitCallExpr(clang::CallExpr* ce) {
+void CallDepthListener::visitStmt(clang::Stmt* stmt, int loopDepth) {
+  if (const auto ce = llvm::dyn_cast<clang::CallExpr>(stmt)) {
     assert(calls.count(ce) == 0);
-    calls.try_emplace(ce, cur_loop_depth);
-    return true;
+    calls.try_emplace(ce, loopDepth);
   }
-};
+}
 
 llvm::SmallDenseMap<const clang::CallExpr*, int, 16> getCallDepthsInStmt(clang::Stmt* s) {
-  if (s == nullptr) {
-    return llvm::SmallDenseMap<const clang::CallExpr*, int, 16>();
-  }
-  CallDepthVisitor visitor;
-  visitor.TraverseStmt(s);
-  return visitor.calls;
+  CallDepthListener counter;
+  BodyStmtListener* listener = &counter;
+  traverseFunctionBody(s, listener);
+  return counter.calls;
 }
 
 class EstimatedCallCountVisitor : public clang::RecursiveASTVisitor<EstimatedCallCountVisitor> {
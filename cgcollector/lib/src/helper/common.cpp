@@ -6,9 +6,35 @@
 
 #include <iostream>
 
-std::vector<std::string> mangleCtorDtor(const clang::FunctionDecl* const nd, clang::MangleContext* mc) {
+namespace {
+// Each ASTContext is created, used and destroyed by a single thread
+thread_local std::unordered_map<const clang::ASTContext*, std::unique_ptr<MangledNameService>> nameServices;
+
+void releaseNameService(void* ctx) { nameServices.erase(static_cast<const clang::ASTContext*>(ctx)); }
+}  // namespace
+
+MangledNameService::MangledNameService(clang::ASTContext& ctx)
+    : nameGenerator(ctx), mangleContext(ctx.createMangleContext()) {}
+
+MangledNameService& MangledNameService::get(clang::ASTContext& ctx) {
+  auto& service = nameServices[&ctx];
+  if (!service) {
+    service = std::unique_ptr<MangledNameService>(new MangledNameService(ctx));
+    // The cache is keyed by declaration addresses, it must not outlive the context
+    ctx.AddDeallocation(releaseNameService, &ctx);
+  }
+  return *service;
+}
+
+const std::vector<std::string>& MangledNameService::getCtorDtorManglings(const clang::FunctionDecl* const nd) {
+  const auto cached = ctorDtorManglings.find(nd);
+  if (cached != ctorDtorManglings.end()) {
+    return cached->second;
+  }
+
+  std::vector<std::string> manglings;
   if (llvm::isa<clang::CXXConstructorDecl>(nd) || llvm::isa<clang::CXXDestructorDecl>(nd)) {
-    std::vector<std::string> manglings;
+    auto mc = mangleContext.get();
 
     const auto mangleCXXCtorAs = [&](clang::CXXCtorType type, const clang::CXXConstructorDecl* nd) {
       std::string functionName;
@@ -49,24 +75,34 @@ std::vector<std::string> mangleCtorDtor(const clang::FunctionDecl* const nd, cla
       manglings.push_back(mangleCXXDtorAs(clang::CXXDtorType::Dtor_Base, dtor));
       manglings.push_back(mangleCXXDtorAs(clang::CXXDtorType::Dtor_Comdat, dtor));
     }
-    return manglings;
   }
-  return {};
+  return ctorDtorManglings.emplace(nd, std::move(manglings)).first->second;
 }
 
-std::vector<std::string> getMangledName(clang::NamedDecl const* const nd) {
-  if (!nd) {
-    std::cerr << "NamedDecl was nullptr" << std::endl;
-    assert(nd && "NamedDecl and MangleContext must not be nullptr");
-    return {"__NO_NAME__"};
+const std::vector<std::string>& MangledNameService::getMangledNames(const clang::NamedDecl* const nd) {
+  const auto cached = mangledNames.find(nd);
+  if (cached != mangledNames.end()) {
+    return cached->second;
   }
-  clang::ASTNameGenerator NG(nd->getASTContext());
 
+  std::vector<std::string> names;
   if (llvm::isa<clang::CXXRecordDecl>(nd) || llvm::isa<clang::CXXMethodDecl>(nd) ||
       llvm::isa<clang::ObjCInterfaceDecl>(nd) || llvm::isa<clang::ObjCImplementationDecl>(nd)) {
-    return NG.getAllManglings(nd);
+    names = nameGenerator.getAllManglings(nd);
+  } else {
+    names = {nameGenerator.getName(nd)};
+  }
+  return mangledNames.emplace(nd, std::move(names)).first->second;
+}
+
+const std::vector<std::string>& getMangledName(clang::NamedDecl const* const nd) {
+  if (!nd) {
+    std::cerr << "NamedDecl was nullptr" << std::endl;
+    assert(nd && "NamedDecl and MangleContext must not be nullptr");
+    static const std::vector<std::string> noName{"__NO_NAME__"};
+    return noName;
   }
-  return {NG.getName(nd)};
+  return MangledNameService::get(nd->getASTContext()).getMangledNames(nd);
 }
 
 clang::Stmt* getCalledStmtFromCXXMemberCall(clang::CXXMemberCallExpr* MCE) {
@@ -0,0 +1,126 @@
+#include "AliasAnalysis.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace implementation;
+
+namespace {
+
+struct ScalingResult {
+  std::size_t NumMerges = 0;
+  std::size_t NumFunctionCalls = 0;
+  double Seconds = .0;
+};
+
+/**
+ * Name of the object Var dereferenced Level times
+ */
+std::string derefName(const std::string& Var, int Level) { return Var + "@" + std::to_string(Level); }
+
+/**
+ * Two pointers with Depth levels of indirection each, the innermost level of the second one is the function f. A call
+ * through the innermost level of the first pointer is only resolved by the merges of the last of the Depth + 1 levels.
+ * Merging the two pointers propagates through all levels.
+ */
+ScalingResult runPointerChain(int Depth) {
+  EquivClassContainer Data;
+  for (const auto& Var : {"p", "q"}) {
+    for (int Level = 0; Level <= Depth; Level++) {
+      Data.addObject(derefName(Var, Level));
+    }
+    for (int Level = 0; Level < Depth; Level++) {
+      Data.addPrefix(Data.getObjectId(derefName(Var, Level)), Prefix(derefName(Var, Level + 1), ""));
+    }
+  }
+  Data.addObject("f");
+  Data.FunctionMap.emplace("f", "f");
+  Data.CallInfoMap["call"].CalledObjects.push_back(derefName("p", Depth));
+  Data.InitClassIndices();
+  mergeRecurisve(Data, Data.getObjectId(derefName("q", Depth)), Data.getObjectId("f"));
+
+  const auto Start = std::chrono::steady_clock::now();
+  const auto Result =
+      mergeRecurisve(Data, Data.getObjectId(derefName("p", 0)), Data.getObjectId(derefName("q", 0)));
+  const auto End = std::chrono::steady_clock::now();
+  return {Result.NumMerges, Result.FunctionCalls.size(), std::chrono::duration<double>(End - Start).count()};
+}
+
+/**
+ * NumStructs struct objects with NumMembers members each. Assigning the structs to each other in a chain merges all
+ * members with the same name.
+ */
+ScalingResult runMemberFanOut(int NumStructs, int NumMembers) {
+  EquivClassContainer Data;
+  for (int S = 0; S < NumStructs; S++) {
+    const auto Struct = "s" + std::to_string(S);
+    const auto StructId = Data.addObject(Struct);
+    for (int M = 0; M < NumMembers; M++) {
+      const auto Member = "m" + std::to_string(M);
+      Data.addObject(Struct + "." + Member);
+      Data.addPrefix(StructId, Prefix(Struct + "." + Member, Member));
+    }
+  }
+  Data.InitClassIndices();
+
+  ScalingResult Result;
+  const auto Start = std::chrono::steady_clock::now();
+  for (int S = 1; S < NumStructs; S++) {
+    const auto Merged = mergeRecurisve(Data, Data.getObjectId("s" + std::to_string(S - 1)),
+                                       Data.getObjectId("s" + std::to_string(S)));
+    Result.NumMerges += Merged.NumMerges;
+    Result.NumFunctionCalls += Merged.FunctionCalls.size();
+  }
+  const auto End = std::chrono::steady_clock::now();
+  Result.Seconds = std::chrono::duration<double>(End - Start).count();
+  return Result;
+}
+
+/**
+ * Runs Scenario for the size N and 8 * N and prints the time per merge step, which should not grow with the size.
+ * A quadratic merge would need about eight times as long per step for the larger size. Wall-clock times are too noisy
+ * on shared machines to fail the test on.
+ */
+template <typename Scenario>
+void reportScaling(const std::string& Name, int N, Scenario&& Run) {
+  constexpr int Repetitions = 3;
+  const auto TimePerMerge = [&](int Size) {
+    double Best = std::numeric_limits<double>::max();
+    for (int I = 0; I < Repetitions; I++) {
+      const auto Result = Run(Size);
+      Best = std::min(Best, Result.Seconds / static_cast<double>(std::max<std::size_t>(Result.NumMerges, 1)));
+    }
+    return Best;
+  };
+  const auto Small = TimePerMerge(N);
+  const auto Large = TimePerMerge(8 * N);
+  std::cout << Name << ": " << Small * 1e9 << " ns per merge for size " << N << ", " << Large * 1e9
+            << " ns per merge for size " << 8 * N << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  int Failures = 0;
+
+  const auto Chain = runPointerChain(100000);
+  if (Chain.NumMerges != 100001 || Chain.NumFunctionCalls != 1) {
+    std::cerr << "Pointer chain: expected 100001 merges and 1 call, got " << Chain.NumMerges << " merges and "
+              << Chain.NumFunctionCalls << " calls" << std::endl;
+    Failures++;
+  }
+
+  const auto FanOut = runMemberFanOut(1000, 100);
+  if (FanOut.NumMerges != 999 * 101 || FanOut.NumFunctionCalls != 0) {
+    std::cerr << "Member fan-out: expected " << 999 * 101 << " merges, got " << FanOut.NumMerges << std::endl;
+    Failures++;
+  }
+
+  reportScaling("Pointer chain", 20000, runPointerChain);
+  reportScaling("Member fan-out", 200, [](int N) { return runMemberFanOut(N, 100); });
+
+  return Failures;
+}
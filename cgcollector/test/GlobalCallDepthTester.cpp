@@ -0,0 +1,86 @@
+#include "GlobalCallDepth.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void addFunction(nlohmann::json& j, const std::string& name, int loopDepth, const nlohmann::json& loopCallDepth,
+                 const std::vector<std::string>& callees) {
+  j["_CG"][name] = {{"callees", callees}, {"meta", {{"loopDepth", loopDepth}, {"loopCallDepth", loopCallDepth}}}};
+}
+
+int getGlobalLoopDepth(const nlohmann::json& j, const std::string& name) {
+  return j["_CG"][name]["meta"]["globalLoopDepth"].get<int>();
+}
+
+bool expectDepth(const nlohmann::json& j, const std::string& name, int expected) {
+  const auto actual = getGlobalLoopDepth(j, name);
+  if (actual != expected) {
+    std::cerr << "Global loop depth of " << name << " is " << actual << ", expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * A chain of Layers diamonds: t_i calls l_i inside a loop and r_i outside of it, both call t_{i+1}.
+ * There are 2^Layers paths from main to the last function.
+ */
+bool testDiamonds() {
+  constexpr int Layers = 64;
+  nlohmann::json j;
+  for (int i = 0; i < Layers; i++) {
+    const auto top = i == 0 ? std::string("main") : "t" + std::to_string(i);
+    const auto left = "l" + std::to_string(i);
+    const auto right = "r" + std::to_string(i);
+    const auto next = "t" + std::to_string(i + 1);
+    addFunction(j, top, 1, {{left, 1}}, {left, right});
+    addFunction(j, left, 0, nlohmann::json::object(), {next});
+    addFunction(j, right, 0, nlohmann::json::object(), {next});
+  }
+  addFunction(j, "t" + std::to_string(Layers), 2, nlohmann::json::object(), {});
+
+  const auto start = std::chrono::steady_clock::now();
+  calculateGlobalCallDepth(j, false);
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << "Diamonds: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+
+  return expectDepth(j, "main", Layers + 2) && expectDepth(j, "r0", Layers + 1) &&
+         expectDepth(j, "t" + std::to_string(Layers), 2);
+}
+
+/**
+ * main -> a -> b -> a (recursion), b -> c, and main -> d -> e -> d with d calling e inside a loop. All functions of a
+ * recursion get the same depth.
+ */
+bool testRecursion() {
+  nlohmann::json j;
+  addFunction(j, "main", 1, {{"a", 1}}, {"a", "d"});
+  addFunction(j, "a", 2, nlohmann::json::object(), {"b"});
+  addFunction(j, "b", 0, {{"c", 0}}, {"a", "c"});
+  addFunction(j, "c", 3, nlohmann::json::object(), {});
+  // Recursion called from within a loop of one of its members
+  addFunction(j, "d", 2, {{"e", 2}}, {"e"});
+  addFunction(j, "e", 1, nlohmann::json::object(), {"d"});
+  addFunction(j, "unreachable", 1, nlohmann::json::object(), {"unreachable"});
+  calculateGlobalCallDepth(j, true);
+
+  return expectDepth(j, "main", 4) && expectDepth(j, "a", 3) && expectDepth(j, "b", 3) && expectDepth(j, "c", 3) &&
+         expectDepth(j, "d", 3) && expectDepth(j, "e", 3) && expectDepth(j, "unreachable", 1);
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  if (!testDiamonds()) {
+    failures++;
+  }
+  if (!testRecursion()) {
+    failures++;
+  }
+  return failures;
+}
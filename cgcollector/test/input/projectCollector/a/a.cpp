@@ -0,0 +1,5 @@
+#include <util.h>
+
+int runB();
+
+int main() { return fromA() + runB(); }
@@ -0,0 +1 @@
+inline int fromA() { return 1; }
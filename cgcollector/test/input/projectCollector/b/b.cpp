@@ -0,0 +1,3 @@
+#include <util.h>
+
+int runB() { return fromB(); }
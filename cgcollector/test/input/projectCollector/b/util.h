@@ -0,0 +1 @@
+inline int fromB() { return 2; }
@@ -0,0 +1 @@
+inline int unused() { return 0; }
@@ -0,0 +1,3 @@
+inline int bar() { return 1; }
+
+inline int foo() { return bar(); }
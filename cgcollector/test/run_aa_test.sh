@@ -45,6 +45,15 @@ multiTestsAA=(0070 0071 0072 0214 0240 0241)
 
 fails=0
 
+# Scaling of the equivalence class merges
+echo " --- Running alias analysis merge scaling test ---"
+../../${build_dir}/cgcollector/test/aamergetester >>log/testrun.log 2>&1
+fail=$?
+if [ $fail -ne 0 ]; then
+  echo "Failure for the merge scaling test. See log/testrun.log"
+fi
+fails=$((fails + fail))
+
 # Single File
 echo " --- Running single file tests [file format version 2.0 with Alias Analysis]---"
 echo " --- Running basic tests ---"
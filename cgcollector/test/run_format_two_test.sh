@@ -36,11 +36,31 @@ else
   cgmergeExe=../../${build_dir}/cgcollector/tools/cgmerge
 fi
 
+if [[ $(type -P $cgprojectcollectorExe) ]]; then
+  echo "No cgprojectcollector in PATH. Trying relative path ../${build_dir}/tools"
+fi
+stat ../../${build_dir}/cgcollector/tools/cgprojectcollector >>log/testrun.log 2>&1
+if [ $? -eq 1 ]; then
+  echo "The file seems also non-present in ../${build_dir}/tools. Aborting test. Failure! Please build the collector first."
+  exit 1
+else
+  cgprojectcollectorExe=../../${build_dir}/cgcollector/tools/cgprojectcollector
+fi
+
 # Multi-file tests
 multiTests=(0042 0043 0044 0050 0053 0060)
 
 fails=0
 
+# Global loop depth on synthetic call graphs
+echo " --- Running global loop depth test ---"
+../../${build_dir}/cgcollector/test/globalcalldepthtester >>log/testrun.log 2>&1
+fail=$?
+if [ $fail -ne 0 ]; then
+  echo "Failure for the global loop depth test. See log/testrun.log"
+fi
+fails=$((fails + fail))
+
 # Single File
 echo " --- Running single file tests [file format version 1.0]---"
 echo " --- Running basic tests ---"
@@ -119,5 +139,19 @@ for tc in "${multiTests[@]}"; do
 done
 echo "Multi file test failuers: $fails"
 
+# Project collector
+echo -e "\n --- Running project collector test ---"
+applyProjectCollectorTest
+fail=$?
+fails=$((fails + fail))
+echo "Project collector test failures: $fails"
+
+# Result cache
+echo -e "\n --- Running result cache test ---"
+applyResultCacheTest
+fail=$?
+fails=$((fails + fail))
+echo "Result cache test failures: $fails"
+
 echo -e "$fails failures occured when running tests"
 exit $fails
@@ -2,6 +2,7 @@
 cgcollectorExe=cgcollector
 testerExe=cgsimpletester
 cgmergeExe=cgmerge
+cgprojectcollectorExe=cgprojectcollector
 build_dir=build # may be changed with opt 'b'
 
 timeStamp=$(date +%s)
@@ -204,13 +205,28 @@ function applyFileFormatTwoToMultiTU {
   ${testerExe} ./input/multiTU/${combFile} ./input/multiTU/${gtCombFile} >>log/testrun.log 2>&1
   cErr=$?
 
-  echo "$aErr or $bErr or $mErr or $cErr"
+  # The merge through the graph library has to yield the same graph as the json merge
+  graphLibCombFile=${tc}_combined-graphlib-${CI_CONCURRENT_ID}.ipcg
+  echo "null" >./input/multiTU/${graphLibCombFile}
 
-  if [[ ${aErr} -ne 0 || ${bErr} -ne 0 || ${mErr} -ne 0 || ${cErr} -ne 0 ]]; then
+  ${cgmergeExe} --graphlib ./input/multiTU/${graphLibCombFile} ./input/multiTU/${ipcgTaFile} ./input/multiTU/${ipcgTbFile} >>log/testrun.log 2>&1
+  gErr=$?
+  if [ ${gErr} -eq 0 ]; then
+    ${testerExe} ./input/multiTU/${combFile} ./input/multiTU/${graphLibCombFile} >>log/testrun.log 2>&1
+    gErr=$?
+  fi
+  if [ ${gErr} -eq 0 ]; then
+    ${testerExe} ./input/multiTU/${graphLibCombFile} ./input/multiTU/${combFile} >>log/testrun.log 2>&1
+    gErr=$?
+  fi
+
+  echo "$aErr or $bErr or $mErr or $cErr or $gErr"
+
+  if [[ ${aErr} -ne 0 || ${bErr} -ne 0 || ${mErr} -ne 0 || ${cErr} -ne 0 || ${gErr} -ne 0 ]]; then
     echo "Failure for file: $combFile. Keeping generated file for inspection"
     fail=$((fail + 1))
   else
-    rm ./input/multiTU/$combFile ./input/multiTU/${ipcgTaFile} ./input/multiTU/${ipcgTbFile}
+    rm ./input/multiTU/$combFile ./input/multiTU/$graphLibCombFile ./input/multiTU/${ipcgTaFile} ./input/multiTU/${ipcgTbFile}
   fi
   return $fail
 }
@@ -267,6 +283,102 @@ function applyFileFormatTwoToMultiTUWithAA {
   return $fail
 }
 
+# Runs the CGCollector with a result cache on a copy of the resultCache input. The header of the test case is found in
+# the second include directory, the first one is searched before.
+# Param 1: The expected number of translation units reused from the cache
+# Param 2: Description of the step
+# Param 3: Additional flags
+function applyResultCacheStep {
+  expectedHits=$1
+  step=$2
+  addFlags=$3
+
+  $cgcollectorExe --metacg-format-version=2 --cache-dir ${cacheDir}/cache ${addFlags} --output ${cacheDir}/main.ipcg ${cacheDir}/main.cpp -- -I${cacheDir}/first -I${cacheDir}/second >${cacheDir}/step.log 2>&1
+  cat ${cacheDir}/step.log >>log/testrun.log
+  if ! grep -q "Reused ${expectedHits} of 1 translation units" ${cacheDir}/step.log; then
+    echo "Result cache: expected ${expectedHits} reused translation units after ${step}"
+    return 1
+  fi
+  return 0
+}
+
+function applyResultCacheTest {
+  fail=0
+  cacheDir=$PWD/log/resultCache-${CI_CONCURRENT_ID}
+  rm -rf ${cacheDir}
+  cp -r ./input/resultCache ${cacheDir}
+
+  applyResultCacheStep 0 "the first run" || fail=$((fail + 1))
+  applyResultCacheStep 1 "an unchanged run" || fail=$((fail + 1))
+  grep -q "bar" ${cacheDir}/main.ipcg || fail=$((fail + 1))
+
+  echo "inline int baz() { return 2; }" >>${cacheDir}/second/header.h
+  applyResultCacheStep 0 "editing the header" || fail=$((fail + 1))
+  applyResultCacheStep 1 "rerunning with the edited header" || fail=$((fail + 1))
+
+  # A header created earlier on the include search path shadows the cached one
+  printf "inline int qux() { return 3; }\n\ninline int foo() { return qux(); }\n" >${cacheDir}/first/header.h
+  applyResultCacheStep 0 "shadowing the header" || fail=$((fail + 1))
+  grep -q "qux" ${cacheDir}/main.ipcg || fail=$((fail + 1))
+
+  applyResultCacheStep 0 "changing an option" "--capture-ctors-dtors" || fail=$((fail + 1))
+  applyResultCacheStep 1 "rerunning with the changed option" "--capture-ctors-dtors" || fail=$((fail + 1))
+
+  if [ $fail -ne 0 ]; then
+    echo "Failure for the result cache test. Keeping ${cacheDir} for inspection"
+  else
+    rm -rf ${cacheDir}
+  fi
+  return $fail
+}
+
+# Compares the whole program call graph of cgprojectcollector with the merge of the cgcollector results per translation
+# unit. Both translation units include <util.h> relative to their own compile directory, with different content.
+function applyProjectCollectorTest {
+  fail=0
+  projectDir=$PWD/log/projectCollector-${CI_CONCURRENT_ID}
+  rm -rf ${projectDir}
+  cp -r ./input/projectCollector ${projectDir}
+  cat >${projectDir}/compile_commands.json <<EOF
+[
+  {"directory": "${projectDir}/a", "command": "clang++ -I. -c a.cpp", "file": "a.cpp"},
+  {"directory": "${projectDir}/b", "command": "clang++ -I. -c b.cpp", "file": "b.cpp"}
+]
+EOF
+
+  # A single job, so both translation units are processed by the same worker
+  $cgprojectcollectorExe --metacg-format-version=2 -p ${projectDir} -j 1 --output ${projectDir}/project.ipcg >>log/testrun.log 2>&1
+  pErr=$?
+
+  $cgcollectorExe --metacg-format-version=2 -p ${projectDir} --output ${projectDir}/a.ipcg ${projectDir}/a/a.cpp >>log/testrun.log 2>&1
+  aErr=$?
+  $cgcollectorExe --metacg-format-version=2 -p ${projectDir} --output ${projectDir}/b.ipcg ${projectDir}/b/b.cpp >>log/testrun.log 2>&1
+  bErr=$?
+  echo "null" >${projectDir}/combined.ipcg
+  ${cgmergeExe} ${projectDir}/combined.ipcg ${projectDir}/a.ipcg ${projectDir}/b.ipcg >>log/testrun.log 2>&1
+  mErr=$?
+
+  ${testerExe} ${projectDir}/combined.ipcg ${projectDir}/project.ipcg >>log/testrun.log 2>&1
+  cErr=$?
+  if [ ${cErr} -eq 0 ]; then
+    ${testerExe} ${projectDir}/project.ipcg ${projectDir}/combined.ipcg >>log/testrun.log 2>&1
+    cErr=$?
+  fi
+  # The included headers have to be resolved per compile directory
+  if ! grep -q "fromA" ${projectDir}/project.ipcg || ! grep -q "fromB" ${projectDir}/project.ipcg; then
+    cErr=1
+  fi
+
+  echo "$pErr or $aErr or $bErr or $mErr or $cErr"
+
+  if [[ ${pErr} -ne 0 || ${aErr} -ne 0 || ${bErr} -ne 0 || ${mErr} -ne 0 || ${cErr} -ne 0 ]]; then
+    echo "Failure for the project collector test. Keeping ${projectDir} for inspection"
+    fail=$((fail + 1))
+  else
+    rm -rf ${projectDir}
+  fi
+  return $fail
+}
 
 while getopts ":b:h" opt; do
   case $opt in
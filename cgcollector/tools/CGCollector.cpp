@@ -1,174 +1,130 @@
 #include "config.h"
 
-#include "AliasAnalysis.h"
-#include "CallGraph.h"
 #include "CallgraphToJSON.h"
-#include "MetaCollector.h"
+#include "CollectorCommandLine.h"
+#include "Parallel.h"
+#include "ResultCache.h"
+#include "TranslationUnitCollector.h"
 
-#include <clang/AST/ASTConsumer.h>
-#include <clang/Frontend/FrontendAction.h>
 #include <clang/Tooling/CommonOptionsParser.h>
-#include <clang/Tooling/Tooling.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
 
-static llvm::cl::OptionCategory cgc("CGCollector");
-static llvm::cl::opt<bool> captureCtorsDtors("capture-ctors-dtors",
-                                             llvm::cl::desc("Capture calls to Constructors and Destructors"),
-                                             llvm::cl::cat(cgc));
-static llvm::cl::opt<bool> noInferCtorDtorCalls("no-infer-ctor-dtor-calls",
-    llvm::cl::desc("Don't infer implicit calls to constructors and destructors"),
-                                         llvm::cl::cat(cgc));
-static llvm::cl::opt<bool> captureStackCtorsDtors(
-    "capture-stack-ctors-dtors",
-    llvm::cl::desc(
-        "Capture calls to Constructors and Destructors of stack allocated variables. (Only works together with AA)"),
-    llvm::cl::cat(cgc));
-static llvm::cl::opt<bool> includeUnusedDecl("include-unused-decl", llvm::cl::desc("Includes unused decls into the CG"),
-                                             llvm::cl::cat(cgc));
-static llvm::cl::opt<int> metacgFormatVersion("metacg-format-version",
-                                              llvm::cl::desc("metacg file version to output, values={1,2}, default=1"),
-                                              llvm::cl::cat(cgc));
-
 static llvm::cl::opt<std::string> outputFilenameOption("output", llvm::cl::desc("Output filename to store MetaCG"),
-                                                       llvm::cl::cat(cgc));
+                                                       llvm::cl::cat(getCollectorCategory()));
 
-/**
- * The classic CG construction and the AA one work a bit differently. The classic one inserts nodes for all function,
- * even if they are never called and do not call any functions themself, the AA one does only include functions that
- * either get called or are calling another function.
- */
-static llvm::cl::opt<bool> disableClassicCGConstruction(
-    "disable-classic-cgc", llvm::cl::desc("Disable the \"classic\" call graph construction"), llvm::cl::cat(cgc));
-static llvm::cl::opt<bool> enableAA("enable-AA", llvm::cl::desc("Enable Alias Analysis (experimental)"),
-                                    llvm::cl::cat(cgc));
-
-// Configuration for the call count estimation
-static llvm::cl::opt<float> loopCountEstimation("cce-loop-count",
-                                                llvm::cl::desc("Loop count estimation for the call count estimation"),
-                                                llvm::cl::init(100.0), llvm::cl::cat(cgc));
-static llvm::cl::opt<float> conditionTrueChance(
-    "cce-condition-true-chance", llvm::cl::desc("Conditional branch true chance for the call count estimation"),
-    llvm::cl::init(0.5), llvm::cl::cat(cgc));
-static llvm::cl::opt<float> exceptionChance(
-    "cce-exception-chance", llvm::cl::desc("Chance of an exception block being executed for the call count estimation"),
-    llvm::cl::init(0.1), llvm::cl::cat(cgc));
-
-typedef std::vector<MetaCollector*> MetaCollectorVector;
-
-class CallGraphCollectorConsumer : public clang::ASTConsumer {
- public:
-  CallGraphCollectorConsumer(MetaCollectorVector mcs, nlohmann::json& j) : _mcs(mcs), _json(j) {}
-
-  virtual void HandleTranslationUnit(clang::ASTContext& Context) {
-    callGraph.setCaptureCtorsDtors(captureCtorsDtors);
-    callGraph.setInferCtorDtorCalls(!noInferCtorDtorCalls);
-    callGraph.setIncludeDecl(includeUnusedDecl);
-    if (!disableClassicCGConstruction) {
-      callGraph.TraverseDecl(Context.getTranslationUnitDecl());
-    }
-    nlohmann::json AliasAnalysisMetadata;
-    if (enableAA) {
-      calculateAliasInfo(Context.getTranslationUnitDecl(), &callGraph, AliasAnalysisMetadata, metacgFormatVersion,
-                         captureCtorsDtors, captureStackCtorsDtors);
-    }
+static llvm::cl::opt<unsigned> numJobs(
+    "jobs", llvm::cl::desc("Number of translation units processed in parallel, 0 uses all hardware threads, default=1"),
+    llvm::cl::init(1), llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::alias numJobsAlias("j", llvm::cl::desc("Alias for -jobs"), llvm::cl::aliasopt(numJobs));
 
-    for (const auto mc : _mcs) {
-      mc->calculateFor(callGraph);
-    }
+static llvm::cl::opt<std::string> cacheDir(
+    "cache-dir",
+    llvm::cl::desc("Directory of the result cache. Translation units whose sources, includes, include search results, "
+                   "compile command and options are unchanged are not analyzed again. Disabled if empty, "
+                   "default=\"\""),
+    llvm::cl::init(""), llvm::cl::cat(getCollectorCategory()));
 
-    convertCallGraphToJSON(callGraph, _json, metacgFormatVersion);
-    if (enableAA && metacgFormatVersion >= 2) {
-      _json["PointerEquivalenceData"] = AliasAnalysisMetadata;
+/**
+ * Everything besides the source and its includes the result of a translation unit depends on
+ */
+std::string getCacheConfiguration(const clang::tooling::CompilationDatabase& compilations,
+                                  const std::string& sourceFile, const CollectorOptions& options) {
+  std::string configuration = std::string(MetaCG_GIT_SHA) + '\n' + LLVM_VERSION_STRING + '\n';
+  for (const auto& command : compilations.getCompileCommands(sourceFile)) {
+    configuration += command.Directory + '\n';
+    for (const auto& arg : command.CommandLine) {
+      configuration += arg + '\0';
     }
+    configuration += '\n';
   }
+  return configuration + getOptionsConfiguration(options);
+}
 
- private:
-  CallGraph callGraph;
-  MetaCollectorVector _mcs;
-  nlohmann::json& _json;
-};
-
-class CallGraphCollectorFactory : clang::ASTFrontendAction {
- public:
-  CallGraphCollectorFactory(MetaCollectorVector mcs, nlohmann::json& j) : _mcs(mcs), _json(j) {}
-
-  std::unique_ptr<clang::ASTConsumer> newASTConsumer() {
-    return std::unique_ptr<clang::ASTConsumer>(new CallGraphCollectorConsumer(_mcs, _json));
-  }
-
-  std::unique_ptr<clang::ASTConsumer> CreateASTConsumer([[maybe_unused]] clang::CompilerInstance& compiler,
-                                                        [[maybe_unused]] llvm::StringRef sr) {
-    return std::unique_ptr<clang::ASTConsumer>(new CallGraphCollectorConsumer(_mcs, _json));
-  }
-
- private:
-  MetaCollectorVector _mcs;
-  nlohmann::json& _json;
-};
-
-// TODO handle multiple inputs
 int main(int argc, const char** argv) {
   if (argc < 2) {
     return -1;
   }
-  metacgFormatVersion.setInitialValue(1);  // Have the old file format as default
   outputFilenameOption.setInitialValue("");
 
   std::cout << "Running metacg::CGCollector (version " << MetaCG_VERSION_MAJOR << '.' << MetaCG_VERSION_MINOR
             << ")\nGit revision: " << MetaCG_GIT_SHA << " LLVM/Clang version: " << LLVM_VERSION_STRING << std::endl;
 
 #if (LLVM_VERSION_MAJOR >= 10) && (LLVM_VERSION_MAJOR <= 12)
-  clang::tooling::CommonOptionsParser OP(argc, argv, cgc);
+  clang::tooling::CommonOptionsParser OP(argc, argv, getCollectorCategory());
 #else
-  auto ParseResult = clang::tooling::CommonOptionsParser::create(argc, argv, cgc);
+  auto ParseResult = clang::tooling::CommonOptionsParser::create(argc, argv, getCollectorCategory());
   if (!ParseResult) {
     std::cerr << toString(ParseResult.takeError()) << "\n";
     return -1;
   }
   clang::tooling::CommonOptionsParser& OP = ParseResult.get();
 #endif
-  clang::tooling::ClangTool CT(OP.getCompilations(), OP.getSourcePathList());
-
-  nlohmann::json j;
-  auto noStmtsCollector = std::make_unique<NumberOfStatementsCollector>();
-  auto foCollector = std::make_unique<FilePropertyCollector>();
-  auto csCollector = std::make_unique<CodeStatisticsCollector>();
-  auto mcCollector = std::make_unique<MallocVariableCollector>();
-  // auto tyCollector = std::make_unique<UniqueTypeCollector>();
-  auto noConditionalBranchesCollector = std::make_unique<NumConditionalBranchCollector>();
-  auto noOperationsCollector = std::make_unique<NumOperationsCollector>();
-  auto loopDepthCollector = std::make_unique<LoopDepthCollector>();
-  auto globalLoopDepthCollector = std::make_unique<GlobalLoopDepthCollector>();
-  auto inlineCollector = std::make_unique<InlineCollector>();
-  auto estimateCallCountCollector = std::make_unique<EstimateCallCountCollector>(
-      loopCountEstimation, conditionTrueChance, 1.0 - conditionTrueChance, exceptionChance);
-
-  MetaCollectorVector mcs{noStmtsCollector.get()};
-  mcs.push_back(foCollector.get());
-  mcs.push_back(csCollector.get());
-  mcs.push_back(mcCollector.get());
-  // mcs.push_back(tyCollector.get());
-  if (metacgFormatVersion > 1) {
-    mcs.push_back(noConditionalBranchesCollector.get());
-    mcs.push_back(noOperationsCollector.get());
-    mcs.push_back(loopDepthCollector.get());
-    mcs.push_back(globalLoopDepthCollector.get());
-    mcs.push_back(inlineCollector.get());
-    mcs.push_back(estimateCallCountCollector.get());
+  const auto& sourceFiles = OP.getSourcePathList();
+  const auto options = getCollectorOptions();
+  if (options.enableAA && sourceFiles.size() > 1) {
+    // The equivalence classes of the alias analysis can only be combined by cgmerge
+    std::cerr << "[Error] The alias analysis supports a single translation unit only. Run cgcollector per translation "
+                 "unit and combine the results with cgmerge."
+              << std::endl;
+    return -1;
   }
 
-  CT.run(
-      clang::tooling::newFrontendActionFactory<CallGraphCollectorFactory>(new CallGraphCollectorFactory(mcs, j)).get());
+  // Translation units are processed independently and reduced in input order, so the result does not depend on the
+  // number of jobs
+  std::vector<nlohmann::json> tuResults(sourceFiles.size());
+  std::optional<ResultCache> cache;
+  if (!cacheDir.empty()) {
+    cache.emplace(cacheDir);
+  }
+  std::atomic<std::size_t> numCacheHits{0};
+  parallelFor(
+      sourceFiles.size(),
+      [&](std::size_t i) {
+        std::string key;
+        if (cache) {
+          key = ResultCache::computeKey(sourceFiles[i],
+                                        getCacheConfiguration(OP.getCompilations(), sourceFiles[i], options));
+          if (auto cached = key.empty() ? std::nullopt : cache->lookup(key)) {
+            tuResults[i] = std::move(*cached);
+            ++numCacheHits;
+            return;
+          }
+        }
+        TranslationUnitDependencies dependencies;
+        if (collectTranslationUnit(OP.getCompilations(), sourceFiles[i], options, tuResults[i],
+                                   cache ? &dependencies : nullptr) != 0) {
+          std::cerr << "[Warning] Errors while processing " << sourceFiles[i] << std::endl;
+        } else if (!key.empty() &&
+                   !cache->store(key, dependencies.includedFiles, dependencies.missingFiles, tuResults[i])) {
+          std::cerr << "[Warning] Could not store the result of " << sourceFiles[i] << " in the cache" << std::endl;
+        }
+      },
+      numJobs);
+
+  if (cache) {
+    std::cout << "Reused " << numCacheHits << " of " << sourceFiles.size() << " translation units from the cache"
+              << std::endl;
+  }
 
-  for (const auto mc : mcs) {
-    addMetaInformationToJSON(j, mc->getName(), mc->getMetaInformation(), metacgFormatVersion);
+  nlohmann::json j;
+  if (tuResults.size() == 1) {
+    j = std::move(tuResults.front());
+  } else {
+    for (auto& tu : tuResults) {
+      mergeTranslationUnitJSON(j, tu, options.metacgFormatVersion);
+      tu = nlohmann::json();
+    }
   }
 
-  for (const auto mc : mcs) {
-    mc->addMetaInformationToCompleteJson(j, metacgFormatVersion);
+  // Whole program meta information needs the merged call graph
+  for (const auto& mc : createMetaCollectors(options)) {
+    mc->addMetaInformationToCompleteJson(j, options.metacgFormatVersion);
   }
 
   // Default to sourcefile.ipcg
@@ -3,7 +3,17 @@
 #include "AliasAnalysis.h"
 #include "GlobalCallDepth.h"
 #include "JSONManager.h"
+#include "Parallel.h"
 
+#include "Callgraph.h"
+#include "MergePolicy.h"
+#include "io/MCGReader.h"
+#include "io/MCGWriter.h"
+// This may appear to be unused, but the variables declared here have side effects on the graph lib
+#include "metadata/BuiltinMD.h"
+
+#include <algorithm>
+#include <memory>
 #include <queue>
 #include <set>
 
@@ -12,34 +22,6 @@
 void mergeEquivalenceClasses(implementation::EquivClassContainer& File1Data, const nlohmann::json& File2,
                              nlohmann::json& wholeCG);
 nlohmann::json mergeFileFormatTwo(const std::string& wholeCGFilename, const std::vector<std::string>& inputFiles) {
-  const auto toSet = [&](auto& jsonObj, const std::string& id) {
-    const auto& obj = jsonObj[id];
-    std::set<std::string> target;
-    for (const auto& e : obj) {
-      target.insert(e.template get<std::string>());
-    }
-    return target;
-  };
-
-  const auto doMerge = [&](auto& t, const auto& s) {
-    auto& callees = s["callees"];
-    std::set<std::string> tCallees{toSet(t, "callees")};
-    for (const auto& c : callees) {
-      tCallees.insert(c.template get<std::string>());
-    }
-    t["callees"] = tCallees;
-
-    auto& overriddenFuncs = s["overrides"];
-    std::set<std::string> tOverriddenFuncs{toSet(t, "overrides")};
-    for (const auto& of : overriddenFuncs) {
-      tOverriddenFuncs.insert(of.template get<std::string>());
-    }
-
-    t["isVirtual"] = s["isVirtual"];
-    t["doesOverride"] = s["doesOverride"];
-    t["hasBody"] = s["hasBody"];
-  };
-
   FuncMapT functionInfoMap;
   nlohmann::json wholeCGFinal, wholeCG;
   std::cout << "Reading " << wholeCGFilename << " as wholeCG file\n";
@@ -72,104 +54,12 @@ nlohmann::json mergeFileFormatTwo(const std::string& wholeCGFilename, const std:
         wholeCG[it.key()] = it.value();
       } else {
         auto& c = wholeCG[it.key()];
-        auto& v = it.value();
-        // TODO multiple bodies possible, if the body is in header?
-        // TODO separate merge of meta information
-        if (v["hasBody"].get<bool>() && c["hasBody"].get<bool>()) {
-          // std::cout << "WARNING: merge of " << it.key()
-          //          << " has detected multiple bodies (equal number of statements would be good.)" << std::endl;
-          // TODO check for equal values
-          doMerge(c, v);
-          // The num Statements should not differ
-          if (c["meta"]["numStatements"].get<int>() != v["meta"]["numStatements"].get<int>()) {
-            // std::cout << "[WARNING] Number of statements for function " << it.key() << " differ." << std::endl;
-            // std::cout << "[WholeCG]: " << c["numStatements"].get<int>()
-            //          << "\n[MergeCG]: " << v["numStatements"].get<int>() << std::endl;
-            c["meta"]["numStatements"] = c["meta"]["numStatements"].get<int>() + v["meta"]["numStatements"].get<int>();
-          }
-          // assert(c["meta"]["numConditionalBranches"].get<int>() == v["meta"]["numConditionalBranches"].get<int>());
-          // assert(c["meta"]["loopDepth"].get<int>() == v["meta"]["loopDepth"].get<int>());
-        } else if (v["hasBody"].get<bool>()) {
-          doMerge(c, v);
-          c["meta"]["numStatements"] = v["meta"]["numStatements"];
-          c["meta"]["fileProperties"] = v["meta"]["fileProperties"];
-          c["meta"]["inlineInfo"] = v["meta"]["inlineInfo"];
-          // TODO JR, find some better way to check if merge is needed
-          if (c["meta"].contains("loopDepth")) {
-            hasLoopInfo = true;
-            c["meta"]["numConditionalBranches"] = v["meta"]["numConditionalBranches"];
-            c["meta"]["loopDepth"] = v["meta"]["loopDepth"];
-            c["meta"]["numOperations"] = v["meta"]["numOperations"];
-          }
-        } else if (c["hasBody"].get<bool>()) {
-          // callees, isVirtual, doesOverride and overriddenFunctions unchanged
-          // hasBody unchanged
-          // numStatements unchanged
-        } else {
-          // nothing special
-        }
-        if (!c["meta"].contains("estimateCallCount") && v["meta"].contains("estimateCallCount")) {
-          c["meta"]["estimateCallCount"] = v["meta"]["estimateCallCount"];
-        } else if (c["meta"].contains("estimateCallCount") && v["meta"].contains("estimateCallCount")) {
-          auto& ccalls = c["meta"]["estimateCallCount"]["calls"];
-          const auto& vcalls = v["meta"]["estimateCallCount"]["calls"];
-          auto& ccodeRegions = c["meta"]["estimateCallCount"]["codeRegions"];
-          const auto& vcodeRegions = v["meta"]["estimateCallCount"]["codeRegions"];
-          for (const auto& [regionName, region] : vcodeRegions.items()) {
-            auto iter = ccodeRegions.find(regionName);
-            if (iter == ccodeRegions.end()) {
-              ccodeRegions[regionName] = region;
-            } else {
-              auto ccodeRegionFunctions = (*iter)["functions"].get<std::set<std::string>>();
-              const auto vcodeRegionFunctions = region["functions"].get<std::set<std::string>>();
-              ccodeRegionFunctions.insert(vcodeRegionFunctions.begin(), vcodeRegionFunctions.end());
-              (*iter)["functions"] = ccodeRegionFunctions;
-            }
-          }
-
-          for (const auto& [functionName, functionInfo] : vcalls.items()) {
-            auto iter = ccalls.find(functionName);
-            if (iter == ccalls.end()) {
-              ccalls[functionName] = functionInfo;
-            } else {
-              auto cfunctioninfo = (*iter).get<std::set<std::pair<double, std::string>>>();
-              const auto vfunctionInfo = functionInfo.get<std::set<std::pair<double, std::string>>>();
-              cfunctioninfo.insert(vfunctionInfo.begin(), vfunctionInfo.end());
-              (*iter) = cfunctioninfo;
-            }
-          }
-        }
-        // Merge the loop depths
-        if (hasLoopInfo) {
-          if (!c["meta"].contains("loopCallDepth") && v["meta"].contains("loopCallDepth")) {
-            c["meta"]["loopCallDepth"] = v["meta"]["loopCallDepth"];
-          } else if (c["meta"].contains("loopCallDepth") && v["meta"].contains("loopCallDepth")) {
-            const auto vd = v["meta"]["loopCallDepth"];
-            auto& vc = c["meta"]["loopCallDepth"];
-            for (const auto& [calledFunction, callDepths] : vc.items()) {
-              const auto other = vd.find(calledFunction);
-              if (other != vd.end()) {
-                const int otherv = *other;
-                if (otherv > callDepths) {
-                  callDepths = otherv;
-                }
-              }
-            }
-            for (const auto& [calledFunction, callDepths] : vd.items()) {
-              if (!vc.contains(calledFunction)) {
-                vc[calledFunction] = callDepths;
-              }
-            }
-          }
-        }
-
-        // merge callers
-        {
-          auto v_parents = v["callers"].get<std::set<std::string>>();
-          std::set<std::string> parents{c["callers"].get<std::set<std::string>>()};
-          parents.insert(std::begin(v_parents), std::end(v_parents));
-          c["callers"] = parents;
+        const auto& v = it.value();
+        // TODO JR, find some better way to check if merge is needed
+        if (!c["hasBody"].get<bool>() && v["hasBody"].get<bool>() && c["meta"].contains("loopDepth")) {
+          hasLoopInfo = true;
         }
+        mergeFunctionJSON(c, v, 2);
       }
     }
 
@@ -209,14 +99,17 @@ nlohmann::json mergeFileFormatTwo(const std::string& wholeCGFilename, const std:
   return wholeCGFinal;
 }
 
+const std::vector<std::string>& getMangledNames(const implementation::EquivClassContainer& Data,
+                                                const StringType& FunctionName) {
+  const auto It = Data.FunctionInfoMap.find(FunctionName);
+  assert(It != Data.FunctionInfoMap.end());
+  return It->second.MangledNames;
+}
+
 void addCallToCallGraph(const implementation::EquivClassContainer& Data, const StringType& CallingFunctionName,
                         const StringType& CalledFunctionName, nlohmann::json& Json) {
-  const auto ItCalling = Data.FunctionInfoMap.find(CallingFunctionName);
-  assert(ItCalling != Data.FunctionInfoMap.end());
-  const auto CallingFunctionNamesMangled = ItCalling->second.MangledNames;
-  const auto ItCalled = Data.FunctionInfoMap.find(CalledFunctionName);
-  assert(ItCalled != Data.FunctionInfoMap.end());
-  const auto CalledFunctionNamesMangled = ItCalled->second.MangledNames;
+  const auto& CallingFunctionNamesMangled = getMangledNames(Data, CallingFunctionName);
+  const auto& CalledFunctionNamesMangled = getMangledNames(Data, CalledFunctionName);
   for (const auto& CallingFunctionNameMangled : CallingFunctionNamesMangled) {
     auto Callees = Json.at(CallingFunctionNameMangled).at("callees").get<std::set<std::string>>();
     auto Inserted = false;
@@ -244,13 +137,28 @@ void addCallToCallGraph(const implementation::EquivClassContainer& Data, const S
   }
 }
 
-void mergeFunctionCall(implementation::EquivClassContainer& Data, const StringType& CalledObj,
-                       implementation::CallInfoConstIterType CE, nlohmann::json& Json) {
+/**
+ * Adds the call to the graph of a partial merge. The callee is inserted without a body if it is defined in another
+ * part, merging the parts by name later on combines it with its definition.
+ */
+void addCallToCallGraph(const implementation::EquivClassContainer& Data, const StringType& CallingFunctionName,
+                        const StringType& CalledFunctionName, metacg::Callgraph& Graph) {
+  for (const auto& CallingFunctionNameMangled : getMangledNames(Data, CallingFunctionName)) {
+    auto& Caller = Graph.getOrInsertNode(CallingFunctionNameMangled);
+    for (const auto& CalledFunctionNameMangled : getMangledNames(Data, CalledFunctionName)) {
+      Graph.addEdge(Caller, Graph.getOrInsertNode(CalledFunctionNameMangled));
+    }
+  }
+}
+
+template <typename CallGraphT>
+void mergeFunctionCall(implementation::EquivClassContainer& Data, implementation::ObjectId CalledObj,
+                       implementation::CallInfoConstIterType CE, CallGraphT& CG) {
   auto Ret = implementation::mergeFunctionCall(Data, CalledObj, CE);
   if (Ret) {
-    addCallToCallGraph(Data, Ret->second.first, Ret->second.second, Json);
+    addCallToCallGraph(Data, Ret->second.first, Ret->second.second, CG);
     for (const auto& ToMerge : Ret->first) {
-      mergeFunctionCall(Data, ToMerge.first, ToMerge.second, Json);
+      mergeFunctionCall(Data, ToMerge.first, ToMerge.second, CG);
     }
   }
 }
@@ -258,13 +166,12 @@ void mergeFunctionCall(implementation::EquivClassContainer& Data, const StringTy
 /**
  *
  * @param File1Data Equivalence Information Container of file 1 (also output)
- * @param File2 Equivalence Information Container of file 2
- * @param wholeCG Output to the _CG json. Only used for adding edges to the callgraph
+ * @param File2Data Equivalence Information Container of file 2
+ * @param CG Output to the _CG json or the call graph. Only used for adding edges to the callgraph
  */
-void mergeEquivalenceClasses(implementation::EquivClassContainer& File1Data, const nlohmann::json& File2,
-                             nlohmann::json& wholeCG) {
-  const implementation::EquivClassContainer File2Data = File2;
-
+template <typename CallGraphT>
+void mergeEquivalenceClasses(implementation::EquivClassContainer& File1Data,
+                             const implementation::EquivClassContainer& File2Data, CallGraphT& CG) {
   // FunctionMap
   for (const auto& Function : File2Data.FunctionMap) {
     File1Data.FunctionMap.emplace(Function);
@@ -299,151 +206,69 @@ void mergeEquivalenceClasses(implementation::EquivClassContainer& File1Data, con
   for (const auto& CallInfo : File2Data.CallInfoMap) {
     File1Data.CallInfoMap.emplace(CallInfo);
   }
-  // ReferencedInCalls
-  File1Data.InitReferencedInCalls();
 
   // CallExprParentMap
   for (const auto& CallExpr : File2Data.CallExprParentMap) {
     File1Data.CallExprParentMap.emplace(CallExpr);
   }
 
-  VectorType<std::pair<StringType, implementation::CallInfoConstIterType>> FunctionsToMerge;
+  VectorType<implementation::FunctionCallToMerge> FunctionsToMerge;
   VectorType<std::pair<StringType, StringType>> ObjectsToMerge;
   // EquivClasses
-  // FindMap
-  for (const auto& Equiv : File2Data.EquivClasses) {
-    /*  Here we need to handle three different cases:
-     *  1. The complete equiv class only exists on the right side:
-     *  copy to the left
-     *  2. All elements are in a single equiv class on the left side:
-     *  merge prefixes ( copy new elements from the right side to them)
-     *  3. The elements are in different classes on the left side:
-     *  Merge on the left side and copy new elements from the right side to them
+  for (const auto& Equiv : File2Data.getEquivClasses()) {
+    /*  The objects of the class are added to the left side if they are new, and all classes on the left side that
+     *  contain an object of the class are merged. The prefixes of the class are merged into the resulting class.
+     *  The function calls of these merges are not needed, as all calls are collected after the merges below.
      */
-    if (Equiv.Objects.size() == 1) {
-      auto It = File1Data.FindMap.find(Equiv.Objects[0]);
-      if (It != File1Data.FindMap.end()) {
-        // Case 2
-        implementation::GetPrefixesToMerge(*It->second, Equiv.Prefixes, ObjectsToMerge);
-        std::sort(It->second->Prefixes.begin(), It->second->Prefixes.end());
-        It->second->Prefixes.erase(std::unique(It->second->Prefixes.begin(), It->second->Prefixes.end()),
-                                   It->second->Prefixes.end());
-      } else {
-        // Case 1
-        File1Data.EquivClasses.emplace_front(Equiv);
-        File1Data.FindMap.emplace(Equiv.Objects[0], File1Data.EquivClasses.begin());
-      }
-    } else {
-      // We have at least two elements
-      bool AllNew = true;
-      auto ItFirst = File1Data.FindMap.find(Equiv.Objects[0]);
-      auto ItFirstInner = File1Data.EquivClasses.end();
-      if (ItFirst != File1Data.FindMap.end()) {
-        AllNew = false;
-        ItFirstInner = ItFirst->second;
-      }
-      for (int I = 1; I < Equiv.Objects.size(); I++) {
-        auto ItSecond = File1Data.FindMap.find(Equiv.Objects[I]);
-        if (AllNew) {
-          AllNew &= (ItSecond == File1Data.FindMap.end());
-          if (!AllNew) {
-            ItFirstInner = ItSecond->second;
-          }
-        } else {
-          if (ItSecond != File1Data.FindMap.end() && ItSecond->second != ItFirstInner) {
-            // Merge the classes pointed to by ItSecond and ItFirst
-            // Case 3
-            assert(ItFirstInner != File1Data.EquivClasses.end());
-
-            const auto Tmp = implementation::merge(File1Data, ItFirstInner, ItSecond->second);
-            ObjectsToMerge.insert(ObjectsToMerge.end(), Tmp.ObjectsToMerge.begin(), Tmp.ObjectsToMerge.end());
-            ItFirstInner = Tmp.Iter->second;
-          } else {
-            // Nothing to do, the element is new or in the same equivalence class
-          }
-        }
-      }
-      if (AllNew) {
-        // Case 1:
-        File1Data.EquivClasses.emplace_front(Equiv);
-        for (const auto& E : Equiv.Objects) {
-          File1Data.FindMap.emplace(E, File1Data.EquivClasses.begin());
-        }
-      } else {
-        // Case 2, 3:
-        assert(ItFirstInner != File1Data.EquivClasses.end());
-        ItFirstInner->Objects.insert(ItFirstInner->Objects.end(), Equiv.Objects.begin(), Equiv.Objects.end());
-        std::sort(ItFirstInner->Objects.begin(), ItFirstInner->Objects.end());
-        ItFirstInner->Objects.erase(std::unique(ItFirstInner->Objects.begin(), ItFirstInner->Objects.end()),
-                                    ItFirstInner->Objects.end());
-
-        implementation::GetPrefixesToMerge(*ItFirstInner, Equiv.Prefixes, ObjectsToMerge);
-        std::sort(ItFirstInner->Prefixes.begin(), ItFirstInner->Prefixes.end());
-        ItFirstInner->Prefixes.erase(std::unique(ItFirstInner->Prefixes.begin(), ItFirstInner->Prefixes.end()),
-                                     ItFirstInner->Prefixes.end());
-
-        for (const auto& E : Equiv.Objects) {
-          File1Data.FindMap.emplace(E, ItFirstInner);
-        }
+    const auto First = File1Data.addObject(Equiv.Objects.front());
+    for (const auto& Obj : Equiv.Objects) {
+      const auto Id = File1Data.addObject(Obj);
+      if (!File1Data.inSameClass(First, Id)) {
+        const auto Tmp = implementation::merge(File1Data, First, Id);
+        ObjectsToMerge.insert(ObjectsToMerge.end(), Tmp.ObjectsToMerge.begin(), Tmp.ObjectsToMerge.end());
       }
     }
+    implementation::GetPrefixesToMerge(File1Data.Prefixes[File1Data.find(First)], Equiv.Prefixes, ObjectsToMerge);
   }
 
+  // Function objects and calls of the classes
+  File1Data.InitClassIndices();
+
   for (const auto& Object : ObjectsToMerge) {
-    const auto It1 = File1Data.FindMap.find(Object.first);
-    const auto It2 = File1Data.FindMap.find(Object.second);
-    if (It1->second != It2->second) {
-      const auto Tmp = implementation::mergeRecurisve(File1Data, It1->second, It2->second);
+    const auto Id1 = File1Data.getObjectId(Object.first);
+    const auto Id2 = File1Data.getObjectId(Object.second);
+    if (!File1Data.inSameClass(Id1, Id2)) {
+      const auto Tmp = implementation::mergeRecurisve(File1Data, Id1, Id2);
     }
   }
 
   for (const auto& Params : ParamsToMerge) {
-    const auto Iter1 = File1Data.FindMap.find(Params.first);
-    const auto Iter2 = File1Data.FindMap.find(Params.second);
-    if (Iter1->second != Iter2->second) {
-      const auto Tmp = implementation::mergeRecurisve(File1Data, Iter1->second, Iter2->second);
-      FunctionsToMerge.insert(FunctionsToMerge.end(), Tmp.first.begin(), Tmp.first.end());
+    const auto Id1 = File1Data.getObjectId(Params.first);
+    const auto Id2 = File1Data.getObjectId(Params.second);
+    if (!File1Data.inSameClass(Id1, Id2)) {
+      const auto Tmp = implementation::mergeRecurisve(File1Data, Id1, Id2);
+      FunctionsToMerge.insert(FunctionsToMerge.end(), Tmp.FunctionCalls.begin(), Tmp.FunctionCalls.end());
     }
   }
 
-  for (const auto& E : File1Data.EquivClasses) {
-    implementation::GetFunctionsToMerge(File1Data, FunctionsToMerge, E);
+  for (implementation::ObjectId Id = 0; Id < File1Data.getNumObjects(); Id++) {
+    if (File1Data.find(Id) == Id) {
+      implementation::GetFunctionsToMerge(File1Data, FunctionsToMerge, Id);
+    }
   }
 
   for (const auto& ToMerge : FunctionsToMerge) {
-    mergeFunctionCall(File1Data, ToMerge.first, ToMerge.second, wholeCG);
+    mergeFunctionCall(File1Data, ToMerge.first, ToMerge.second, CG);
   }
 }
 
-nlohmann::json mergeFileFormatOne(const std::string& wholeCGFilename, const std::vector<std::string>& inputFiles) {
-  const auto toSet = [&](auto& jsonObj, std::string id) {
-    const auto& obj = jsonObj[id];
-    std::set<std::string> target;
-    for (const auto& e : obj) {
-      target.insert(e.template get<std::string>());
-    }
-    return target;
-  };
-
-  const auto doMerge = [&](auto& t, const auto& s) {
-    auto& callees = s["callees"];
-    std::set<std::string> tCallees{toSet(t, "callees")};
-    for (const auto& c : callees) {
-      tCallees.insert(c.template get<std::string>());
-    }
-    t["callees"] = tCallees;
-
-    auto& overriddenFuncs = s["overriddenFunctions"];
-    std::set<std::string> tOverriddenFuncs{toSet(t, "overriddenFunctions")};
-    for (const auto& of : overriddenFuncs) {
-      tOverriddenFuncs.insert(of.template get<std::string>());
-    }
-
-    t["isVirtual"] = s["isVirtual"];
-    t["doesOverride"] = s["doesOverride"];
-    t["hasBody"] = s["hasBody"];
-  };
+void mergeEquivalenceClasses(implementation::EquivClassContainer& File1Data, const nlohmann::json& File2,
+                             nlohmann::json& wholeCG) {
+  const implementation::EquivClassContainer File2Data = File2;
+  mergeEquivalenceClasses(File1Data, File2Data, wholeCG);
+}
 
+nlohmann::json mergeFileFormatOne(const std::string& wholeCGFilename, const std::vector<std::string>& inputFiles) {
   FuncMapT functionInfoMap;
   nlohmann::json wholeCG;
   std::cout << "Reading " << wholeCGFilename << " as wholeCG file\n";
@@ -459,40 +284,7 @@ nlohmann::json mergeFileFormatOne(const std::string& wholeCGFilename, const std:
       if (wholeCG[it.key()].empty()) {
         wholeCG[it.key()] = it.value();
       } else {
-        auto& c = wholeCG[it.key()];
-        auto& v = it.value();
-        // TODO multiple bodies possible, if the body is in header?
-        // TODO separate merge of meta information
-        if (v["hasBody"].get<bool>() && c["hasBody"].get<bool>()) {
-          // std::cout << "WARNING: merge of " << it.key()
-          //          << " has detected multiple bodies (equal number of statements would be good.)" << std::endl;
-          // TODO check for equal values
-          doMerge(c, v);
-          // The num Statements should not differ
-          if (c["numStatements"].get<int>() != v["numStatements"].get<int>()) {
-            // std::cout << "[WARNING] Number of statements for function " << it.key() << " differ." << std::endl;
-            // std::cout << "[WholeCG]: " << c["numStatements"].get<int>()
-            //          << "\n[MergeCG]: " << v["numStatements"].get<int>() << std::endl;
-            c["numStatements"] = c["numStatements"].get<int>() + v["numStatements"].get<int>();
-          }
-        } else if (v["hasBody"].get<bool>()) {
-          doMerge(c, v);
-          c["numStatements"] = v["numStatements"];
-        } else if (c["hasBody"].get<bool>()) {
-          // callees, isVirtual, doesOverride and overriddenFunctions unchanged
-          // hasBody unchanged
-          // numStatements unchanged
-        } else {
-          // nothing special
-        }
-
-        // merge callers
-        {
-          auto v_parents = v["parents"].get<std::set<std::string>>();
-          std::set<std::string> parents{c["parents"].get<std::set<std::string>>()};
-          parents.insert(std::begin(v_parents), std::end(v_parents));
-          c["parents"] = parents;
-        }
+        mergeFunctionJSON(wholeCG[it.key()], it.value(), 1);
       }
     }
   }
@@ -509,20 +301,155 @@ nlohmann::json mergeFileFormatOne(const std::string& wholeCGFilename, const std:
   return wholeCG;
 }
 
+/**
+ * The merged call graph and alias analysis data of a range of input files
+ */
+struct PartialMerge {
+  std::unique_ptr<metacg::Callgraph> graph;
+  std::optional<implementation::EquivClassContainer> aaData;
+  std::string formatVersion;
+  // The format version of the file cannot be read by the graph library
+  bool unsupported{false};
+};
+
+/**
+ * Reads an input file through the graph library. The calls found by its alias analysis data are added to its graph.
+ * @return The partial merge of the file, without a graph if the file cannot be read or its format version is not
+ * supported by the graph library
+ */
+PartialMerge readWithGraphLib(const std::string& filename) {
+  PartialMerge result;
+  try {
+    metacg::io::FileSource fs(filename);
+    const auto j = fs.get();
+    if (j.is_null()) {
+      // Typically the output file, which is passed as an input as well
+      return result;
+    }
+    result.formatVersion = fs.getFormatVersion();
+    auto reader = metacg::io::createReader(fs);
+    if (!reader) {
+      std::cerr << "[Error] Cannot read " << filename << " with format version " << result.formatVersion
+                << ", --graphlib supports format versions 2 and 4 only" << std::endl;
+      result.unsupported = true;
+      return result;
+    }
+    result.graph = reader->read();
+    if (j.contains("PointerEquivalenceData")) {
+      result.aaData.emplace();
+      mergeEquivalenceClasses(*result.aaData, j["PointerEquivalenceData"].get<implementation::EquivClassContainer>(),
+                              *result.graph);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "[Warning] Could not read " << filename << ": " << e.what() << std::endl;
+    result.graph.reset();
+  }
+  return result;
+}
+
+/**
+ * Merges source into target, source is empty afterwards. Calls that only become visible by combining the alias
+ * analysis data of both are added to the graph of target.
+ */
+void mergePartials(PartialMerge& target, PartialMerge& source) {
+  target.graph->merge(*source.graph, metacg::MergeByName());
+  source.graph.reset();
+  if (!source.aaData) {
+    return;
+  }
+  if (!target.aaData) {
+    target.aaData = std::move(source.aaData);
+  } else {
+    mergeEquivalenceClasses(*target.aaData, *source.aaData, *target.graph);
+  }
+  source.aaData.reset();
+}
+
+/**
+ * Merges the input files with the graph library, i.e., with the metacg::io readers and writers and the MergeByName
+ * policy, instead of on the json representation. The files are read in parallel, and combined pairwise in a tree of
+ * depth log2(#files), where the merges of each level run in parallel. The PointerEquivalenceData is merged alongside
+ * the graphs.
+ */
+nlohmann::json mergeWithGraphLib(const std::string& wholeCGFilename, const std::vector<std::string>& inputFiles) {
+  nlohmann::json wholeCGFinal;
+  readIPCG(wholeCGFilename, wholeCGFinal);
+  if (!wholeCGFinal.is_null()) {
+    std::cerr << "Expecting empty json file to write Whole Program metacg to." << std::endl;
+    exit(-1);
+  }
+
+  std::vector<PartialMerge> partials(inputFiles.size());
+  parallelFor(inputFiles.size(), [&](std::size_t i) { partials[i] = readWithGraphLib(inputFiles[i]); });
+  if (std::any_of(partials.begin(), partials.end(), [](const auto& p) { return p.unsupported; })) {
+    // Skipping the file would silently lose its calls
+    std::cerr << "[Error] Merge the input files without --graphlib" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  partials.erase(std::remove_if(partials.begin(), partials.end(), [](const auto& p) { return !p.graph; }),
+                 partials.end());
+  if (partials.empty()) {
+    std::cerr << "[Error] All input files are NULL" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  const auto formatVersion = partials.front().formatVersion;
+  for (const auto& p : partials) {
+    if (p.formatVersion != formatVersion) {
+      std::cerr << "[Warning] File format versions of the input files do not match" << std::endl;
+      break;
+    }
+  }
+
+  std::cout << "Now starting merge of " << partials.size() << " files." << std::endl;
+  // On each level, the partial merge at index i absorbs the one at i + stride
+  for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+    const auto numMerges = (partials.size() + stride - 1) / (2 * stride);
+    parallelFor(numMerges, [&](std::size_t m) {
+      const auto target = 2 * stride * m;
+      mergePartials(partials[target], partials[target + stride]);
+    });
+  }
+
+  auto writer = metacg::io::createWriter(std::stoi(formatVersion));
+  if (!writer) {
+    std::cerr << "[Error] Unable to create a writer for format version " << formatVersion << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  metacg::io::JsonSink jsonSink;
+  writer->write(partials.front().graph.get(), jsonSink);
+  wholeCGFinal = jsonSink.getJson();
+  if (partials.front().aaData) {
+    wholeCGFinal["PointerEquivalenceData"] = *partials.front().aaData;
+  }
+  return wholeCGFinal;
+}
+
 int main(int argc, char** argv) {
-  if (argc < 3) {
+  // Usage: cgmerge [--graphlib] <outfile> <infile1> <infile2> ...
+  const bool useGraphLib = argc > 1 && std::string(argv[1]) == "--graphlib";
+  const int outfilePos = useGraphLib ? 2 : 1;
+  if (argc < outfilePos + 2) {
     return -1;
   }
+  const std::string outfile = argv[outfilePos];
 
   std::cout << "Running metacg::CGMerge (version " << MetaCG_VERSION_MAJOR << '.' << MetaCG_VERSION_MINOR
             << ")\nGit revision: " << MetaCG_GIT_SHA << std::endl;
 
   std::vector<std::string> inputFiles;
   // inputFiles.reserve(argc - 2);
-  for (int i = 2; i < argc; ++i) {
+  for (int i = outfilePos + 1; i < argc; ++i) {
     inputFiles.emplace_back(argv[i]);
   }
 
+  if (useGraphLib) {
+    auto wholeCG = mergeWithGraphLib(outfile, inputFiles);
+    writeIPCG(outfile, wholeCG);
+    std::cout << "Done merging" << std::endl;
+    return 0;
+  }
+
   nlohmann::json j;
   bool foundValidFile{false};
   bool useFileFormatTwo{false};
@@ -544,11 +471,11 @@ int main(int argc, char** argv) {
   }
   j.clear();
   if (useFileFormatTwo) {
-    auto wholeCG = mergeFileFormatTwo(argv[1], inputFiles);
-    writeIPCG(argv[1], wholeCG);
+    auto wholeCG = mergeFileFormatTwo(outfile, inputFiles);
+    writeIPCG(outfile, wholeCG);
   } else {
-    auto wholeCG = mergeFileFormatOne(argv[1], inputFiles);
-    writeIPCG(argv[1], wholeCG);
+    auto wholeCG = mergeFileFormatOne(outfile, inputFiles);
+    writeIPCG(outfile, wholeCG);
   }
 
   std::cout << "Done merging" << std::endl;
@@ -0,0 +1,207 @@
+#include "config.h"
+
+#include "CallgraphToJSON.h"
+#include "CollectorCommandLine.h"
+#include "Parallel.h"
+#include "TranslationUnitCollector.h"
+
+#include <clang/Tooling/CommonOptionsParser.h>
+#include <llvm/Support/FileSystem.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+static llvm::cl::opt<std::string> outputFilenameOption("output",
+                                                       llvm::cl::desc("Output filename to store the whole program "
+                                                                      "MetaCG, default=\"wholeProgramCG.ipcg\""),
+                                                       llvm::cl::init("wholeProgramCG.ipcg"),
+                                                       llvm::cl::cat(getCollectorCategory()));
+
+static llvm::cl::opt<unsigned> numJobs(
+    "jobs", llvm::cl::desc("Number of translation units processed in parallel, 0 uses all hardware threads, default=0"),
+    llvm::cl::init(0), llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::alias numJobsAlias("j", llvm::cl::desc("Alias for -jobs"), llvm::cl::aliasopt(numJobs));
+
+static llvm::cl::opt<unsigned> memoryBudget(
+    "memory-budget",
+    llvm::cl::desc("Memory in MB for results that finished before they can be merged. Workers do not start new "
+                   "translation units while the budget is exceeded, default=1024"),
+    llvm::cl::init(1024), llvm::cl::cat(getCollectorCategory()));
+
+namespace {
+
+/**
+ * Orders the translation units by the size of their source, largest first, so a large translation unit does not start
+ * last and leaves the other workers idle
+ */
+std::vector<std::string> scheduleBySize(std::vector<std::string> sourceFiles) {
+  std::vector<std::pair<uint64_t, std::string>> sized;
+  sized.reserve(sourceFiles.size());
+  for (auto& source : sourceFiles) {
+    uint64_t size = 0;
+    if (llvm::sys::fs::file_size(source, size)) {
+      size = 0;
+    }
+    sized.emplace_back(size, std::move(source));
+  }
+  std::stable_sort(sized.begin(), sized.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  std::vector<std::string> schedule;
+  schedule.reserve(sized.size());
+  for (auto& [size, source] : sized) {
+    schedule.push_back(std::move(source));
+  }
+  return schedule;
+}
+
+/**
+ * Merges the results of the translation units in schedule order, so the whole program call graph does not depend on
+ * the number of jobs. Results that finish early are kept serialized until all previous ones are merged.
+ */
+class IncrementalMerge {
+ public:
+  IncrementalMerge(std::size_t numTUs, std::size_t budgetBytes, int mcgFormatVersion)
+      : numTUs(numTUs), budgetBytes(budgetBytes), mcgFormatVersion(mcgFormatVersion) {}
+
+  /**
+   * Claims the next translation unit to process. Blocks while the buffered results exceed the budget. The translation
+   * unit that is merged next has already been claimed in that case, so its worker always drains the buffer.
+   * @return false if all translation units have been claimed
+   */
+  bool claim(std::size_t& tu) {
+    std::unique_lock<std::mutex> lock(mutex);
+    budgetAvailable.wait(lock, [this]() { return bufferedBytes <= budgetBytes || nextTU == numTUs; });
+    if (nextTU == numTUs) {
+      return false;
+    }
+    tu = nextTU++;
+    return true;
+  }
+
+  void finish(std::size_t tu, nlohmann::json result) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (tu != nextToMerge) {
+        auto serialized = result.dump();
+        bufferedBytes += serialized.size();
+        peakBufferedBytes = std::max(peakBufferedBytes, bufferedBytes);
+        buffered.emplace(tu, std::move(serialized));
+        return;
+      }
+    }
+    // Only the worker of the next translation unit touches the merged graph, the others only buffer their results
+    for (;;) {
+      if (numTUs == 1) {
+        merged = std::move(result);
+      } else {
+        mergeTranslationUnitJSON(merged, result, mcgFormatVersion);
+      }
+      result = nlohmann::json();
+
+      std::string serialized;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto next = buffered.find(++nextToMerge);
+        if (next == buffered.end()) {
+          return;
+        }
+        serialized = std::move(next->second);
+        buffered.erase(next);
+        bufferedBytes -= serialized.size();
+      }
+      budgetAvailable.notify_all();
+      result = nlohmann::json::parse(serialized);
+    }
+  }
+
+  nlohmann::json& getMerged() { return merged; }
+
+  std::size_t getPeakBufferedBytes() const { return peakBufferedBytes; }
+
+ private:
+  const std::size_t numTUs;
+  const std::size_t budgetBytes;
+  const int mcgFormatVersion;
+
+  std::mutex mutex;
+  std::condition_variable budgetAvailable;
+  std::size_t nextTU = 0;
+  std::size_t nextToMerge = 0;
+  std::map<std::size_t, std::string> buffered;
+  std::size_t bufferedBytes = 0;
+  std::size_t peakBufferedBytes = 0;
+
+  nlohmann::json merged;
+};
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  std::cout << "Running metacg::CGProjectCollector (version " << MetaCG_VERSION_MAJOR << '.' << MetaCG_VERSION_MINOR
+            << ")\nGit revision: " << MetaCG_GIT_SHA << " LLVM/Clang version: " << LLVM_VERSION_STRING << std::endl;
+
+  // Without sources, all translation units of the compilation database are processed
+#if (LLVM_VERSION_MAJOR >= 10) && (LLVM_VERSION_MAJOR <= 12)
+  clang::tooling::CommonOptionsParser OP(argc, argv, getCollectorCategory(), llvm::cl::ZeroOrMore);
+#else
+  auto ParseResult =
+      clang::tooling::CommonOptionsParser::create(argc, argv, getCollectorCategory(), llvm::cl::ZeroOrMore);
+  if (!ParseResult) {
+    std::cerr << toString(ParseResult.takeError()) << "\n";
+    return -1;
+  }
+  clang::tooling::CommonOptionsParser& OP = ParseResult.get();
+#endif
+  const auto options = getCollectorOptions();
+  if (options.enableAA) {
+    std::cerr << "[Error] The alias analysis supports a single translation unit only. Run cgcollector per translation "
+                 "unit and combine the results with cgmerge."
+              << std::endl;
+    return -1;
+  }
+
+  const auto& compilations = OP.getCompilations();
+  const auto sourceFiles =
+      scheduleBySize(OP.getSourcePathList().empty() ? compilations.getAllFiles() : OP.getSourcePathList());
+  if (sourceFiles.empty()) {
+    std::cerr << "[Error] No translation units to process" << std::endl;
+    return -1;
+  }
+
+  IncrementalMerge merge(sourceFiles.size(), static_cast<std::size_t>(memoryBudget) * 1024 * 1024,
+                         options.metacgFormatVersion);
+  // The workers claim the translation units from the merge, which limits the buffered results
+  const auto numThreads = getNumWorkers(sourceFiles.size(), numJobs);
+  runWorkers(numThreads, [&](std::size_t) {
+    // Files included by several translation units of a compile directory are looked up once per worker
+    std::map<std::string, CollectorWorkspace> workspaces;
+    std::size_t i;
+    while (merge.claim(i)) {
+      const auto directory = getCompileDirectory(compilations, sourceFiles[i]);
+      auto& workspace = workspaces.try_emplace(directory, directory).first->second;
+      nlohmann::json tu;
+      if (collectTranslationUnit(compilations, sourceFiles[i], options, tu, nullptr, &workspace) != 0) {
+        std::cerr << "[Warning] Errors while processing " << sourceFiles[i] << std::endl;
+      }
+      merge.finish(i, std::move(tu));
+    }
+  });
+  std::cout << "Processed " << sourceFiles.size() << " translation units with " << numThreads << " jobs, at most "
+            << merge.getPeakBufferedBytes() / 1024 << " KB of results waited to be merged" << std::endl;
+
+  // Whole program meta information needs the merged call graph
+  auto& j = merge.getMerged();
+  for (const auto& mc : createMetaCollectors(options)) {
+    mc->addMetaInformationToCompleteJson(j, options.metacgFormatVersion);
+  }
+
+  std::ofstream file(outputFilenameOption);
+  file << j << std::endl;
+
+  return 0;
+}
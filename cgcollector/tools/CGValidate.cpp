@@ -2,15 +2,22 @@
 
 #include "JSONManager.h"
 #include "MetaInformation.h"
+#include "Parallel.h"
 
 #include "cxxopts.hpp"
 
 #include <Cube.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <set>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #ifndef LOGLEVEL
 #define LOGLEVEL 0
@@ -138,41 +145,204 @@ void patchCallgraph(nlohmann::json& callgraph, const std::string& nodeName, cons
 
 std::set<std::pair<std::string, std::string>> edgesChecked;
 
-// Ripped from pgis
-const auto cMetric = [](std::string&& name, auto&& cube, auto cn) {
-  if constexpr (std::is_pointer_v<decltype(cn)>) {
-    const auto met = cube.get_met(name.c_str());
-    typedef decltype(cube.get_sev(met, cn, cube.get_thrdv().at(0))) RetType;
-    RetType metric{};
-    for (auto t : cube.get_thrdv()) {
-      metric += cube.get_sev(met, cn, t);
+// Sums the severity of metric for cnode over all threads
+double sumOverThreads(cube::Cube& cube, cube::Metric* metric, cube::Cnode* cnode) {
+  double sum{};
+  for (auto t : cube.get_thrdv()) {
+    sum += cube.get_sev(metric, cnode, t);
+  }
+  return sum;
+}
+
+namespace {
+
+using NodeId = std::uint32_t;
+
+/**
+ * Hashed index of the call graph for the edge checks. Function names are mapped to dense ids, the callee and caller
+ * lists are sets of (function, callee/caller) pairs, and the overridden functions of every function are resolved
+ * transitively once instead of per checked edge.
+ * Nodes are only added before the checks start, so edges can be checked concurrently.
+ */
+class CallgraphIndex {
+ public:
+  CallgraphIndex(const nlohmann::json& callgraph, const std::string& parentKey, const std::string& overridesKey) {
+    for (const auto& [name, node] : callgraph.items()) {
+      const auto id = intern(name);
+      inCallgraph[id] = true;
+      if (node.contains("hasBody") && !node["hasBody"].is_null()) {
+        hasBodyState[id] = node["hasBody"].get<bool>() ? 1 : 0;
+      }
     }
-    return metric;
-  } else {
-    assert(false);
+    std::vector<std::vector<NodeId>> directlyOverridden(names.size());
+    for (const auto& [name, node] : callgraph.items()) {
+      const auto id = ids.at(name);
+      if (node.contains("callees")) {
+        for (const auto& callee : node["callees"]) {
+          callees.insert(key(id, intern(callee.get<std::string>())));
+        }
+      }
+      if (node.contains(parentKey)) {
+        for (const auto& caller : node[parentKey]) {
+          callers.insert(key(id, intern(caller.get<std::string>())));
+        }
+      }
+      if (node.contains(overridesKey)) {
+        for (const auto& overridden : node[overridesKey]) {
+          directlyOverridden[id].push_back(intern(overridden.get<std::string>()));
+        }
+      }
+    }
+
+    // The edge lists may have added names
+    directlyOverridden.resize(names.size());
+    std::vector<char> state(names.size(), Unresolved);
+    for (NodeId id = 0; id < names.size(); ++id) {
+      resolveOverridden(id, directlyOverridden, state);
+    }
+  }
+
+  /**
+   * Id of the function, if it is part of the call graph
+   */
+  std::optional<NodeId> find(const std::string& name) const {
+    const auto it = ids.find(name);
+    if (it == ids.end() || !inCallgraph[it->second]) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  /**
+   * Adds a function without edges and body, i.e., a node inserted by insertDefaultNode
+   */
+  NodeId addEmptyNode(const std::string& name) {
+    const auto id = intern(name);
+    inCallgraph[id] = true;
+    hasBodyState[id] = 0;
+    return id;
   }
+
+  const std::string& getName(NodeId id) const { return names[id]; }
+
+  bool contains(NodeId id) const { return inCallgraph[id]; }
+
+  bool hasCallee(NodeId node, NodeId callee) const { return callees.count(key(node, callee)) != 0; }
+
+  bool hasCaller(NodeId node, NodeId caller) const { return callers.count(key(node, caller)) != 0; }
+
+  /**
+   * Whether the function has a body, empty if the IPCG does not contain the information
+   */
+  std::optional<bool> hasBody(NodeId id) const {
+    if (hasBodyState[id] < 0) {
+      return std::nullopt;
+    }
+    return hasBodyState[id] == 1;
+  }
+
+  /**
+   * All functions that are overridden by the function, directly or transitively. May contain functions that are not
+   * part of the call graph.
+   */
+  const std::vector<NodeId>& getOverriddenFunctions(NodeId id) const { return overriddenClosure[id]; }
+
+ private:
+  static constexpr char Unresolved = 0;
+  static constexpr char InProgress = 1;
+  static constexpr char Resolved = 2;
+
+  static std::uint64_t key(NodeId node, NodeId other) { return (static_cast<std::uint64_t>(node) << 32) | other; }
+
+  NodeId intern(const std::string& name) {
+    const auto [it, inserted] = ids.try_emplace(name, static_cast<NodeId>(names.size()));
+    if (inserted) {
+      names.push_back(name);
+      inCallgraph.push_back(false);
+      hasBodyState.push_back(-1);
+      overriddenClosure.emplace_back();
+    }
+    return it->second;
+  }
+
+  void resolveOverridden(NodeId id, const std::vector<std::vector<NodeId>>& directlyOverridden,
+                         std::vector<char>& state) {
+    if (state[id] != Unresolved) {
+      // Cyclic overrides are only followed once
+      return;
+    }
+    state[id] = InProgress;
+    std::vector<NodeId> closure;
+    for (const auto overridden : directlyOverridden[id]) {
+      resolveOverridden(overridden, directlyOverridden, state);
+      closure.push_back(overridden);
+      closure.insert(closure.end(), overriddenClosure[overridden].begin(), overriddenClosure[overridden].end());
+    }
+    std::sort(closure.begin(), closure.end());
+    closure.erase(std::unique(closure.begin(), closure.end()), closure.end());
+    overriddenClosure[id] = std::move(closure);
+    state[id] = Resolved;
+  }
+
+  std::unordered_map<std::string, NodeId> ids;
+  std::vector<std::string> names;
+  // Names are also interned if they only appear in edge lists
+  std::vector<bool> inCallgraph;
+  std::vector<signed char> hasBodyState;
+  std::vector<std::vector<NodeId>> overriddenClosure;
+  std::unordered_set<std::uint64_t> callees;
+  std::unordered_set<std::uint64_t> callers;
+};
+
+/**
+ * An edge of the profile and the result of its check
+ */
+struct EdgeCheck {
+  NodeId parent;
+  NodeId node;
+  bool parentMissing = false;
+  bool calleeMissing = false;
 };
-const auto getVisits = [](auto&& cube, auto cn) { return cMetric(std::string("visits"), cube, cn); };
-
-// Recursively computes the set of all functions that are overridden by baseFn
-std::unordered_set<std::string> getAllOverriddenFunctions(nlohmann::json& cg, nlohmann::json& baseFn,
-                                                          const std::string& overridesKey) {
-  std::unordered_set<std::string> overriddenSet;
-  auto overrides = baseFn[overridesKey];
-  std::for_each(overrides.begin(), overrides.end(),
-                [&cg, &overriddenSet, &overridesKey](const std::string& overridesFn) {
-                  if (!cg.contains(overridesFn)) {
-                    return;
-                  }
-                  auto& fnNode = cg[overridesFn];
-                  overriddenSet.insert(overridesFn);
-                  for (auto& entry : getAllOverriddenFunctions(cg, fnNode, overridesKey)) {
-                    overriddenSet.insert(entry);
-                  }
-                });
-  return overriddenSet;
+
+/**
+ * Checks every edge against the index. The edges are distributed in chunks over all hardware threads, and each check
+ * only writes the result into its own edge.
+ */
+void checkEdges(const CallgraphIndex& index, std::vector<EdgeCheck>& edges, bool useNoBodyDetection) {
+  const auto check = [&](EdgeCheck& edge) {
+    const auto& overriddenFunctions = index.getOverriddenFunctions(edge.node);
+    // check if parent contains callee and callee contains parent
+    auto calleeFound = index.hasCallee(edge.parent, edge.node);
+    auto parentFound = index.hasCaller(edge.node, edge.parent);
+    // check polymorphism, only overridden functions of the call graph count
+    const auto overriddenFunctionParentFound =
+        std::any_of(overriddenFunctions.begin(), overriddenFunctions.end(), [&](NodeId overridden) {
+          return index.contains(overridden) && index.hasCaller(overridden, edge.parent);
+        });
+    const auto overriddenFunctionCalleeFound =
+        std::any_of(overriddenFunctions.begin(), overriddenFunctions.end(), [&](NodeId overridden) {
+          return index.contains(overridden) && index.hasCallee(edge.parent, overridden);
+        });
+
+    if (useNoBodyDetection) {
+      calleeFound = calleeFound || !index.hasBody(edge.parent).value_or(true);  // if no body av, how should we know?
+      parentFound = parentFound || !index.hasBody(edge.node).value_or(true);    // if no body av, how should we know?
+    }
+    edge.parentMissing = !parentFound && !overriddenFunctionParentFound;
+    edge.calleeMissing = !calleeFound && !overriddenFunctionCalleeFound;
+  };
+
+  constexpr std::size_t ChunkSize = 1024;
+  parallelFor((edges.size() + ChunkSize - 1) / ChunkSize, [&](std::size_t chunk) {
+    const auto end = std::min((chunk + 1) * ChunkSize, edges.size());
+    for (auto i = chunk * ChunkSize; i < end; ++i) {
+      check(edges[i]);
+    }
+  });
 }
 
+}  // namespace
+
 int main(int argc, char** argv) {
   std::string ipcg;
   std::string cubex;
@@ -217,13 +387,15 @@ int main(int argc, char** argv) {
     return 3;
   }
 
-  // iterate over cube to check if edges are in callgraph
+  // iterate over cube to collect the call counts and the distinct edges
   bool verified = true;
   const auto& cnodes = cube.get_cnodev();
+  const auto visitsMetric = cube.get_met("visits");
+  std::vector<std::pair<std::string, std::string>> profileEdges;
 
   for (const auto cnode : cnodes) {
     const auto calledName = cnode->get_callee()->get_mangled_name();
-    const auto visits = getVisits(cube, cnode);
+    const auto visits = sumOverThreads(cube, visitsMetric, cnode);
     totalCallCounts[calledName] += visits;
     const auto caller = cnode->get_caller();
     if (caller) {
@@ -231,102 +403,83 @@ int main(int argc, char** argv) {
       assert(!caller_name.empty());
       callCounts[caller_name][calledName] += visits;
     }
-  }
 
-  for (const auto cnode : cnodes) {
-    // get cube elements
     // continue if we are in root element or main
-    if (!cnode->get_parent()) {
-      continue;
-    }
-    const std::string nodeName = cnode->get_callee()->get_mangled_name();
-    if (isMain(nodeName)) {
+    if (!cnode->get_parent() || isMain(calledName)) {
       continue;
     }
     const std::string parentName = cnode->get_parent()->get_callee()->get_mangled_name();
+    if (edgesChecked.insert(std::make_pair(parentName, calledName)).second) {
+      profileEdges.emplace_back(parentName, calledName);
+    }
+  }
 
+  CallgraphIndex index(callgraph, parentKey, overridesKey);
+  // Functions of the profile that are missing in the call graph are inserted before the checks
+  const auto getOrInsertIndexed = [&](const std::string& name) -> std::optional<NodeId> {
+    if (const auto id = index.find(name)) {
+      return id;
+    }
+    if (!getOrInsert(callgraph, name, insertNewNodes, version)) {
+      return std::nullopt;
+    }
+    return index.addEmptyNode(name);
+  };
+  std::vector<EdgeCheck> edges;
+  edges.reserve(profileEdges.size());
+  for (const auto& [parentName, nodeName] : profileEdges) {
     if (LOGLEVEL > 0) {
       std::cout << "[INFO] edge reached: " << parentName << " --> " << nodeName << std::endl;
     }
-    edgesChecked.insert(std::make_pair(parentName, nodeName));
-
-    // get callgraph elements
-    if (!getOrInsert(callgraph, parentName, insertNewNodes, version)) {
+    const auto parent = getOrInsertIndexed(parentName);
+    if (!parent) {
       continue;
     }
-    auto parent = callgraph[parentName];
-    auto callees = parent["callees"];
-    if (!getOrInsert(callgraph, nodeName, insertNewNodes, version)) {
+    const auto node = getOrInsertIndexed(nodeName);
+    if (!node) {
       continue;
     }
-    auto node = callgraph[nodeName];
-    auto parents = node[parentKey];
+    edges.push_back({*parent, *node});
+  }
 
-    // check if parent contains callee and callee contains parent
-    auto calleeFound =
-        (std::find(callees.begin(), callees.end(), nodeName) != callees.end());  // doesInclude(callees, nodeName);
-    auto parentFound =
-        (std::find(parents.begin(), parents.end(), parentName) != parents.end());  // doesInclude(parents, parentName);
-    // check polymorphism
-    bool overriddenFunctionParentFound = false;
-    bool overriddenFunctionCalleeFound = false;
-    const auto& overriddenFunctions = getAllOverriddenFunctions(callgraph, node, overridesKey);
-    for (const std::string overriddenFunctionName : overriddenFunctions) {
-      if (!getOrInsert(callgraph, overriddenFunctionName, insertNewNodes, version)) {
-        continue;
-      }
-      const auto& overriddenFunction = callgraph[overriddenFunctionName];
-      const auto& parents = overriddenFunction[parentKey];
-      overriddenFunctionParentFound = (std::find(parents.begin(), parents.end(), parentName) != parents.end());
-      if (overriddenFunctionParentFound) {
-        break;
-      }
-    }
-    for (const std::string overriddenFunctionName : overriddenFunctions) {
-      overriddenFunctionCalleeFound =
-          (std::find(callees.begin(), callees.end(), overriddenFunctionName) != callees.end());
-      if (overriddenFunctionCalleeFound) {
-        break;
-      }
-    }
+  checkEdges(index, edges, useNoBodyDetection);
 
+  // reporting, the patches are applied after all edges are checked
+  std::vector<std::tuple<std::string, std::string, std::string>> patches;
+  for (const auto& edge : edges) {
+    const auto& parentName = index.getName(edge.parent);
+    const auto& nodeName = index.getName(edge.node);
     if (useNoBodyDetection) {
-      bool pHasBody{true};
-      bool cHasBody{true};
-      if (parent["hasBody"].is_null()) {
+      if (!index.hasBody(edge.parent)) {
         std::cerr << "[Warning] No CGCollector data for " << parentName << " in IPCG." << std::endl;
-      } else {
-        pHasBody = parent["hasBody"].get<bool>();
       }
-      if (node["hasBody"].is_null()) {
+      if (!index.hasBody(edge.node)) {
         std::cerr << "[Warning] No CGCollector data for " << nodeName << " in IPCG." << std::endl;
-      } else {
-        cHasBody = node["hasBody"].get<bool>();
       }
-      calleeFound = calleeFound || !pHasBody;  // if no body av, how should we know?
-      parentFound = parentFound || !cHasBody;  // if no body av, how should we know?
     }
 
-    // reporting
-    if (!parentFound && !overriddenFunctionParentFound) {
+    if (edge.parentMissing) {
       std::cout << "[Error] " << nodeName << " does not contain parent " << parentName << std::endl;
       verified = false;
       if (patch) {
-        patchCallgraph(callgraph, nodeName, parentName, parentKey, output, insertNewNodes, version);
+        patches.emplace_back(nodeName, parentName, parentKey);
       }
     }
-    if ((!calleeFound && !overriddenFunctionCalleeFound) || useCubeCallCounts) {
-      if (!calleeFound && !overriddenFunctionCalleeFound) {
+    if (edge.calleeMissing || useCubeCallCounts) {
+      if (edge.calleeMissing) {
         std::cout << "[Error] " << parentName << " does not contain callee " << nodeName << std::endl;
       } else {
         std::cout << "[Info] patching in cube call counts for " << parentName << std::endl;
       }
       verified = false;
       if (patch) {
-        patchCallgraph(callgraph, parentName, nodeName, "callees", output, insertNewNodes, version);
+        patches.emplace_back(parentName, nodeName, "callees");
       }
     }
   }
+  for (const auto& [nodeName, valueName, mode] : patches) {
+    patchCallgraph(callgraph, nodeName, valueName, mode, output, insertNewNodes, version);
+  }
   if (useCubeCallCounts) {
     for (auto& [key, value] : callgraph.items()) {
       auto nExists = getOrInsert(callgraph, key, insertNewNodes, version);
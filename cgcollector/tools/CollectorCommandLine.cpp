@@ -0,0 +1,62 @@
+#include "CollectorCommandLine.h"
+
+llvm::cl::OptionCategory& getCollectorCategory() {
+  // Function local, as the options of the tools are registered during static initialization
+  static llvm::cl::OptionCategory cgc("CGCollector");
+  return cgc;
+}
+
+static llvm::cl::opt<bool> captureCtorsDtors("capture-ctors-dtors",
+                                             llvm::cl::desc("Capture calls to Constructors and Destructors"),
+                                             llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<bool> noInferCtorDtorCalls(
+    "no-infer-ctor-dtor-calls", llvm::cl::desc("Don't infer implicit calls to constructors and destructors"),
+    llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<bool> captureStackCtorsDtors(
+    "capture-stack-ctors-dtors",
+    llvm::cl::desc(
+        "Capture calls to Constructors and Destructors of stack allocated variables. (Only works together with AA)"),
+    llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<bool> includeUnusedDecl("include-unused-decl", llvm::cl::desc("Includes unused decls into the CG"),
+                                             llvm::cl::cat(getCollectorCategory()));
+// Have the old file format as default
+static llvm::cl::opt<int> metacgFormatVersion("metacg-format-version",
+                                              llvm::cl::desc("metacg file version to output, values={1,2}, default=1"),
+                                              llvm::cl::init(1), llvm::cl::cat(getCollectorCategory()));
+
+/**
+ * The classic CG construction and the AA one work a bit differently. The classic one inserts nodes for all function,
+ * even if they are never called and do not call any functions themself, the AA one does only include functions that
+ * either get called or are calling another function.
+ */
+static llvm::cl::opt<bool> disableClassicCGConstruction(
+    "disable-classic-cgc", llvm::cl::desc("Disable the \"classic\" call graph construction"),
+    llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<bool> enableAA("enable-AA", llvm::cl::desc("Enable Alias Analysis (experimental)"),
+                                    llvm::cl::cat(getCollectorCategory()));
+
+// Configuration for the call count estimation
+static llvm::cl::opt<float> loopCountEstimation("cce-loop-count",
+                                                llvm::cl::desc("Loop count estimation for the call count estimation"),
+                                                llvm::cl::init(100.0), llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<float> conditionTrueChance(
+    "cce-condition-true-chance", llvm::cl::desc("Conditional branch true chance for the call count estimation"),
+    llvm::cl::init(0.5), llvm::cl::cat(getCollectorCategory()));
+static llvm::cl::opt<float> exceptionChance(
+    "cce-exception-chance", llvm::cl::desc("Chance of an exception block being executed for the call count estimation"),
+    llvm::cl::init(0.1), llvm::cl::cat(getCollectorCategory()));
+
+CollectorOptions getCollectorOptions() {
+  CollectorOptions options;
+  options.captureCtorsDtors = captureCtorsDtors;
+  options.inferCtorDtorCalls = !noInferCtorDtorCalls;
+  options.captureStackCtorsDtors = captureStackCtorsDtors;
+  options.includeUnusedDecl = includeUnusedDecl;
+  options.disableClassicCGConstruction = disableClassicCGConstruction;
+  options.enableAA = enableAA;
+  options.metacgFormatVersion = metacgFormatVersion;
+  options.loopCountEstimation = loopCountEstimation;
+  options.conditionTrueChance = conditionTrueChance;
+  options.exceptionChance = exceptionChance;
+  return options;
+}
@@ -0,0 +1,18 @@
+#ifndef CGCOLLECTOR_COLLECTORCOMMANDLINE_H
+#define CGCOLLECTOR_COLLECTORCOMMANDLINE_H
+
+#include "TranslationUnitCollector.h"
+
+#include <llvm/Support/CommandLine.h>
+
+/**
+ * Command line options of the call graph construction, shared by cgcollector and cgprojectcollector
+ */
+llvm::cl::OptionCategory& getCollectorCategory();
+
+/**
+ * The collector options as given on the command line, only valid after the command line is parsed
+ */
+CollectorOptions getCollectorOptions();
+
+#endif  // CGCOLLECTOR_COLLECTORCOMMANDLINE_H
@@ -261,6 +261,20 @@ class Callgraph : public MetadataMixin {
    */
   CgNodeRawPtrUSet getCallers(NodeId id) const;
 
+  /**
+   * Provides access to the stored callee IDs of the given node without building a set.
+   * @param id
+   * @return The list of callee IDs. Empty if the node has no callees.
+   */
+  const NodeList& getCalleeIds(NodeId id) const;
+
+  /**
+   * Provides access to the stored caller IDs of the given node without building a set.
+   * @param id
+   * @return The list of caller IDs. Empty if the node has no callers.
+   */
+  const NodeList& getCallerIds(NodeId id) const;
+
   /**
    * Returns the number of inserted nodes. Note that this includes erased nodes.
    * @return
@@ -319,7 +333,9 @@ class Callgraph : public MetadataMixin {
   template <class T>
   bool addEdgeMetaData(const std::pair<NodeId, NodeId> id, std::unique_ptr<T>&& md) {
     if (auto it = edges.find(id); it != edges.end()) {
-      it->second[T::key] = std::move(md);
+      // Metadata created by the factory only has the static type of the base class
+      const std::string key = md->getKey();
+      it->second[key] = std::move(md);
       return true;
     }
     return false;
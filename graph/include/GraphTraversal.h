@@ -0,0 +1,167 @@
+/**
+ * File: GraphTraversal.h
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#ifndef METACG_GRAPHTRAVERSAL_H
+#define METACG_GRAPHTRAVERSAL_H
+
+#include "Callgraph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace metacg::analysis {
+
+enum class TraversalDirection { Callees, Callers };
+
+/**
+ * Returned by traversal visitors to steer the traversal.
+ * Continue: expand the neighbors of the visited node.
+ * Prune: do not expand the neighbors of the visited node.
+ * Stop: terminate the traversal immediately.
+ */
+enum class VisitResult { Continue, Prune, Stop };
+
+/**
+ * Reusable traversal engine over the edges of a call graph.
+ * Visited flags are kept as epoch stamps indexed by node ID, so starting a new traversal is O(1) and repeated queries
+ * do not allocate once the buffers have grown to the graph size.
+ * Visitors are called as `VisitResult visit(CgNode* node, unsigned depth)`.
+ * A single instance must not be used for concurrent or nested traversals.
+ */
+class GraphTraversal {
+ public:
+  static constexpr unsigned Unbounded = std::numeric_limits<unsigned>::max();
+
+  explicit GraphTraversal(const Callgraph* graph) : cg(graph) {}
+
+  /**
+   * Breadth-first traversal from all given sources (depth 0). Every node is visited once, at its minimal depth.
+   * Neighbors of nodes at maxDepth are not expanded.
+   * @return True if the visitor stopped the traversal, false otherwise.
+   */
+  template <typename Iterator, typename Visitor>
+  bool bfs(Iterator firstSource, Iterator lastSource, TraversalDirection direction, unsigned maxDepth,
+           Visitor&& visit) {
+    beginEpoch();
+    frontier.clear();
+    for (; firstSource != lastSource; ++firstSource) {
+      if (markVisited(*firstSource)) {
+        frontier.push_back(*firstSource);
+      }
+    }
+
+    for (unsigned depth = 0; !frontier.empty(); ++depth) {
+      nextFrontier.clear();
+      for (const auto id : frontier) {
+        const auto result = visit(cg->getNode(id), depth);
+        if (result == VisitResult::Stop) {
+          return true;
+        }
+        if (result == VisitResult::Prune || depth >= maxDepth) {
+          continue;
+        }
+        for (const auto neighbor : getNeighbors(id, direction)) {
+          if (markVisited(neighbor)) {
+            nextFrontier.push_back(neighbor);
+          }
+        }
+      }
+      std::swap(frontier, nextFrontier);
+    }
+    return false;
+  }
+
+  template <typename Visitor>
+  bool bfs(NodeId source, TraversalDirection direction, unsigned maxDepth, Visitor&& visit) {
+    return bfs(&source, &source + 1, direction, maxDepth, std::forward<Visitor>(visit));
+  }
+
+  /**
+   * Depth-first (pre-order) traversal from all given sources. Every node is visited once, at the depth it is first
+   * reached with, which is not necessarily its minimal depth. Use bfs if the depth bound has to be exact.
+   * @return True if the visitor stopped the traversal, false otherwise.
+   */
+  template <typename Iterator, typename Visitor>
+  bool dfs(Iterator firstSource, Iterator lastSource, TraversalDirection direction, unsigned maxDepth,
+           Visitor&& visit) {
+    beginEpoch();
+    stack.clear();
+    for (; firstSource != lastSource; ++firstSource) {
+      stack.emplace_back(*firstSource, 0);
+    }
+    // Sources are visited in the given order
+    std::reverse(stack.begin(), stack.end());
+
+    while (!stack.empty()) {
+      const auto [id, depth] = stack.back();
+      stack.pop_back();
+      if (!markVisited(id)) {
+        continue;
+      }
+      const auto result = visit(cg->getNode(id), depth);
+      if (result == VisitResult::Stop) {
+        return true;
+      }
+      if (result == VisitResult::Prune || depth >= maxDepth) {
+        continue;
+      }
+      const auto& neighbors = getNeighbors(id, direction);
+      for (auto it = neighbors.rbegin(); it != neighbors.rend(); ++it) {
+        if (!isVisited(*it)) {
+          stack.emplace_back(*it, depth + 1);
+        }
+      }
+    }
+    return false;
+  }
+
+  template <typename Visitor>
+  bool dfs(NodeId source, TraversalDirection direction, unsigned maxDepth, Visitor&& visit) {
+    return dfs(&source, &source + 1, direction, maxDepth, std::forward<Visitor>(visit));
+  }
+
+  /**
+   * Bidirectional search for a call path from source to target with at most maxEdges edges.
+   * Expands the smaller of the callee frontier of source and the caller frontier of target per step.
+   */
+  bool existsPath(NodeId source, NodeId target, unsigned maxEdges = Unbounded);
+
+  /** Query if node was visited by the most recent traversal */
+  bool isVisited(NodeId id) const { return id < visitedEpoch.size() && visitedEpoch[id] == epoch; }
+
+ private:
+  const Callgraph::NodeList& getNeighbors(NodeId id, TraversalDirection direction) const {
+    return direction == TraversalDirection::Callees ? cg->getCalleeIds(id) : cg->getCallerIds(id);
+  }
+
+  /** Marks node as visited. Returns false if it was visited before in the current traversal. */
+  bool markVisited(NodeId id) {
+    if (visitedEpoch[id] == epoch) {
+      return false;
+    }
+    visitedEpoch[id] = epoch;
+    return true;
+  }
+
+  /** Starts a new traversal, invalidating all visited flags */
+  void beginEpoch();
+
+  const Callgraph* cg;
+  std::uint32_t epoch{0};
+  std::vector<std::uint32_t> visitedEpoch;
+  std::vector<std::uint32_t> reverseVisitedEpoch;  // backward half of the bidirectional search
+  std::vector<NodeId> frontier;
+  std::vector<NodeId> nextFrontier;
+  std::vector<NodeId> reverseFrontier;
+  std::vector<std::pair<NodeId, unsigned>> stack;
+};
+
+}  // namespace metacg::analysis
+
+#endif  // METACG_GRAPHTRAVERSAL_H
@@ -9,8 +9,9 @@
 #include "spdlog/fmt/bundled/core.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
-#include <unordered_set>
 #include <iostream>
+#include <mutex>
+#include <unordered_set>
 
 namespace metacg {
 /**
@@ -23,6 +24,12 @@ class MCGLogger {
     return instance;
   }
 
+  // Copies share the loggers and start with the unique messages logged so far
+  MCGLogger(const MCGLogger& other) : console(other.console), errconsole(other.errconsole) {
+    const std::lock_guard<std::mutex> lock(other.uniqueMutex);
+    alreadyPrintedMessages = other.alreadyPrintedMessages;
+  }
+
   /**
    * Get non-owning raw pointer to underlying spdlog logger
    * @return
@@ -261,6 +268,7 @@ class MCGLogger {
    * @return the number of messages that now can appear again
    */
   size_t resetUniqueCache(){
+    const std::lock_guard<std::mutex> lock(uniqueMutex);
     const size_t deletedEntries=alreadyPrintedMessages.size();
     alreadyPrintedMessages.clear();
     return deletedEntries;
@@ -273,11 +281,12 @@ class MCGLogger {
   inline bool ensureUnique(const std::string& formattedMessage) {
     if constexpr (lt == LogType::UNIQUE) {
       const size_t msg_hash = std::hash<std::string>()(formattedMessage);
+      // Graphs may be read concurrently, e.g., by cgmerge
+      const std::lock_guard<std::mutex> lock(uniqueMutex);
       // If we found the msg, we just return
-      if (alreadyPrintedMessages.find(msg_hash) != alreadyPrintedMessages.end()) {
+      if (!alreadyPrintedMessages.insert(msg_hash).second) {
         return true;
       }
-      alreadyPrintedMessages.insert(std::hash<std::string>()(formattedMessage));
     }
     return false;
   }
@@ -285,6 +294,7 @@ class MCGLogger {
   std::shared_ptr<spdlog::logger> console;
   std::shared_ptr<spdlog::logger> errconsole;
   std::unordered_set<size_t> alreadyPrintedMessages;
+  mutable std::mutex uniqueMutex;
 };
 
 namespace loggerutil {
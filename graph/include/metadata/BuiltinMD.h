@@ -18,6 +18,7 @@
 #include "metadata/NumOperationsMD.h"
 #include "metadata/NumStatementsMD.h"
 #include "metadata/OverrideMD.h"
+#include "metadata/RuntimeCallCountMD.h"
 #include "metadata/UniqueTypeMD.h"
 
 #endif  // METACG_BUILTINMD_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+/**
+ * File: RuntimeCallCountMD.h
+ * License: Part of the MetaCG project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+#ifndef METACG_RUNTIMECALLCOUNTMD_H
+#define METACG_RUNTIMECALLCOUNTMD_H
+
+#include "metadata/MetaData.h"
+
+namespace metacg {
+
+/**
+ * Edge metadata: how often a call edge was observed at runtime, and when it was observed first.
+ * Attached by the cgpatch runtime if call counting is enabled.
+ */
+class RuntimeCallCountMD : public metacg::MetaData::Registrar<RuntimeCallCountMD> {
+ public:
+  static constexpr const char* key = "runtimeCallCount";
+  RuntimeCallCountMD() = default;
+  RuntimeCallCountMD(uint64_t count, uint64_t firstSeen) : count(count), firstSeen(firstSeen) {}
+  explicit RuntimeCallCountMD(const nlohmann::json& j, StrToNodeMapping&) {
+    if (j.is_null()) {
+      metacg::MCGLogger::instance().getConsole()->trace("Could not retrieve meta data for {}", key);
+      return;
+    }
+    count = j.at("count").get<uint64_t>();
+    firstSeen = j.at("firstSeen").get<uint64_t>();
+  }
+
+ private:
+  RuntimeCallCountMD(const RuntimeCallCountMD& other) = default;
+
+ public:
+  nlohmann::json toJson(NodeToStrMapping&) const final { return {{"count", count}, {"firstSeen", firstSeen}}; }
+
+  const char* getKey() const override { return key; }
+
+  void merge(const MetaData& toMerge, std::optional<MergeAction>, const GraphMapping&) final {
+    assert(toMerge.getKey() == getKey() && "Trying to merge RuntimeCallCountMD with meta data of different types");
+
+    const auto* toMergeDerived = static_cast<const RuntimeCallCountMD*>(&toMerge);
+    add(toMergeDerived->count, toMergeDerived->firstSeen);
+  }
+
+  std::unique_ptr<MetaData> clone() const final { return std::unique_ptr<MetaData>(new RuntimeCallCountMD(*this)); }
+
+  void applyMapping(const GraphMapping&) override {}
+
+  /**
+   * Accounts for further observations of the edge
+   */
+  void add(uint64_t moreCalls, uint64_t seen) {
+    if (moreCalls == 0) {
+      return;
+    }
+    firstSeen = count == 0 ? seen : std::min(firstSeen, seen);
+    count += moreCalls;
+  }
+
+  uint64_t getCount() const { return count; }
+
+  /**
+   * Nanoseconds from the start of the observing process to the first observation
+   */
+  uint64_t getFirstSeen() const { return firstSeen; }
+
+ private:
+  uint64_t count{0};
+  uint64_t firstSeen{0};
+};
+
+}  // namespace metacg
+
+#endif  // METACG_RUNTIMECALLCOUNTMD_H
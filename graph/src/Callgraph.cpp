@@ -400,6 +400,22 @@ CgNodeRawPtrUSet Callgraph::getCallers(NodeId node) const {
   return returnSet;
 }
 
+const Callgraph::NodeList& Callgraph::getCalleeIds(NodeId id) const {
+  static const NodeList noNodes;
+  if (auto it = calleeList.find(id); it != calleeList.end()) {
+    return it->second;
+  }
+  return noNodes;
+}
+
+const Callgraph::NodeList& Callgraph::getCallerIds(NodeId id) const {
+  static const NodeList noNodes;
+  if (auto it = callerList.find(id); it != callerList.end()) {
+    return it->second;
+  }
+  return noNodes;
+}
+
 MetaData* Callgraph::getEdgeMetaData(const CgNode& func1, const CgNode& func2, const std::string& metadataName) const {
   if (hasNode(func1) && hasNode(func2)) {
     return getEdgeMetaData({func1.getId(), func2.getId()}, metadataName);
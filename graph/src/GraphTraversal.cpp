@@ -0,0 +1,64 @@
+/**
+ * File: GraphTraversal.cpp
+ * License: Part of the MetaCG project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "GraphTraversal.h"
+
+#include <algorithm>
+
+namespace metacg::analysis {
+
+void GraphTraversal::beginEpoch() {
+  // Nodes may have been inserted since the last traversal
+  const auto numNodes = cg->size();
+  if (visitedEpoch.size() < numNodes) {
+    visitedEpoch.resize(numNodes, 0);
+    reverseVisitedEpoch.resize(numNodes, 0);
+  }
+
+  if (++epoch == 0) {
+    // Wrap around: stale stamps could collide with the new epochs
+    std::fill(visitedEpoch.begin(), visitedEpoch.end(), 0);
+    std::fill(reverseVisitedEpoch.begin(), reverseVisitedEpoch.end(), 0);
+    epoch = 1;
+  }
+}
+
+bool GraphTraversal::existsPath(NodeId source, NodeId target, unsigned maxEdges) {
+  if (source == target) {
+    return true;
+  }
+  beginEpoch();
+  visitedEpoch[source] = epoch;
+  reverseVisitedEpoch[target] = epoch;
+  frontier.assign(1, source);
+  reverseFrontier.assign(1, target);
+
+  // Both frontiers are complete BFS levels. The sum of their depths bounds the length of any path found.
+  for (unsigned numEdges = 0; numEdges < maxEdges && !frontier.empty() && !reverseFrontier.empty(); ++numEdges) {
+    const bool forward = frontier.size() <= reverseFrontier.size();
+    auto& expanded = forward ? frontier : reverseFrontier;
+    auto& ownEpochs = forward ? visitedEpoch : reverseVisitedEpoch;
+    const auto& otherEpochs = forward ? reverseVisitedEpoch : visitedEpoch;
+    const auto direction = forward ? TraversalDirection::Callees : TraversalDirection::Callers;
+
+    nextFrontier.clear();
+    for (const auto id : expanded) {
+      for (const auto neighbor : getNeighbors(id, direction)) {
+        if (otherEpochs[neighbor] == epoch) {
+          return true;
+        }
+        if (ownEpochs[neighbor] != epoch) {
+          ownEpochs[neighbor] = epoch;
+          nextFrontier.push_back(neighbor);
+        }
+      }
+    }
+    std::swap(expanded, nextFrontier);
+  }
+  return false;
+}
+
+}  // namespace metacg::analysis
@@ -0,0 +1,125 @@
+/**
+ * File: GraphTraversalTest.cpp
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "gtest/gtest.h"
+
+#include "GraphTraversal.h"
+#include "LoggerUtil.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+using namespace metacg::analysis;
+
+class GraphTraversalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    metacg::loggerutil::getLogger();
+    // main -> a -> b -> c -> d, main -> e -> c, d -> a (cycle), f isolated
+    for (const auto name : {"main", "a", "b", "c", "d", "e", "f"}) {
+      cg.insert(name);
+    }
+    cg.addEdge("main", "a");
+    cg.addEdge("a", "b");
+    cg.addEdge("b", "c");
+    cg.addEdge("c", "d");
+    cg.addEdge("main", "e");
+    cg.addEdge("e", "c");
+    cg.addEdge("d", "a");
+  }
+
+  metacg::NodeId id(const std::string& name) { return cg.getFirstNode(name)->getId(); }
+
+  metacg::Callgraph cg;
+};
+
+TEST_F(GraphTraversalTest, BFSReportsMinimalDepth) {
+  GraphTraversal traversal(&cg);
+  std::vector<std::pair<std::string, unsigned>> visited;
+  const bool stopped = traversal.bfs(id("main"), TraversalDirection::Callees, GraphTraversal::Unbounded,
+                                     [&](metacg::CgNode* node, unsigned depth) {
+                                       visited.emplace_back(node->getFunctionName(), depth);
+                                       return VisitResult::Continue;
+                                     });
+  EXPECT_FALSE(stopped);
+  ASSERT_EQ(visited.size(), 6);
+  for (const auto& [name, depth] : visited) {
+    if (name == "c") {
+      EXPECT_EQ(depth, 2);
+    } else if (name == "d") {
+      EXPECT_EQ(depth, 3);
+    }
+  }
+  EXPECT_FALSE(traversal.isVisited(id("f")));
+}
+
+TEST_F(GraphTraversalTest, DepthBoundAndPruning) {
+  GraphTraversal traversal(&cg);
+  unsigned count = 0;
+  traversal.bfs(id("main"), TraversalDirection::Callees, 1, [&](metacg::CgNode*, unsigned) {
+    ++count;
+    return VisitResult::Continue;
+  });
+  EXPECT_EQ(count, 3);
+
+  // Pruning at e leaves c reachable via a -> b only
+  traversal.bfs(id("main"), TraversalDirection::Callees, 2, [&](metacg::CgNode* node, unsigned) {
+    return node->getFunctionName() == "e" ? VisitResult::Prune : VisitResult::Continue;
+  });
+  EXPECT_TRUE(traversal.isVisited(id("b")));
+  EXPECT_FALSE(traversal.isVisited(id("c")));
+}
+
+TEST_F(GraphTraversalTest, EarlyExitAndMultiSource) {
+  GraphTraversal traversal(&cg);
+  const std::vector<metacg::NodeId> sources{id("d"), id("e")};
+  unsigned count = 0;
+  const bool stopped = traversal.bfs(sources.begin(), sources.end(), TraversalDirection::Callers,
+                                     GraphTraversal::Unbounded, [&](metacg::CgNode* node, unsigned depth) {
+                                       ++count;
+                                       return node->getFunctionName() == "main" ? VisitResult::Stop
+                                                                                : VisitResult::Continue;
+                                     });
+  EXPECT_TRUE(stopped);
+  // d, e at depth 0, c and main at depth 1
+  EXPECT_LE(count, 4);
+}
+
+TEST_F(GraphTraversalTest, DFSVisitsEachNodeOnce) {
+  GraphTraversal traversal(&cg);
+  std::vector<std::string> visited;
+  traversal.dfs(id("a"), TraversalDirection::Callees, GraphTraversal::Unbounded, [&](metacg::CgNode* node, unsigned) {
+    visited.push_back(node->getFunctionName());
+    return VisitResult::Continue;
+  });
+  EXPECT_EQ(visited, (std::vector<std::string>{"a", "b", "c", "d"}));
+}
+
+TEST_F(GraphTraversalTest, BidirectionalPathQueries) {
+  GraphTraversal traversal(&cg);
+  EXPECT_TRUE(traversal.existsPath(id("main"), id("main"), 0));
+  EXPECT_TRUE(traversal.existsPath(id("main"), id("d")));
+  EXPECT_FALSE(traversal.existsPath(id("main"), id("d"), 2));
+  EXPECT_TRUE(traversal.existsPath(id("main"), id("d"), 3));
+  EXPECT_TRUE(traversal.existsPath(id("d"), id("c"), 3));
+  EXPECT_FALSE(traversal.existsPath(id("d"), id("c"), 2));
+  EXPECT_FALSE(traversal.existsPath(id("a"), id("e")));
+  EXPECT_FALSE(traversal.existsPath(id("main"), id("f")));
+}
+
+TEST_F(GraphTraversalTest, HandlesNodesInsertedAfterConstruction) {
+  GraphTraversal traversal(&cg);
+  EXPECT_FALSE(traversal.existsPath(id("f"), id("main")));
+  cg.insert("g");
+  cg.addEdge("f", "g");
+  cg.addEdge("g", "main");
+  EXPECT_TRUE(traversal.existsPath(id("f"), id("main"), 2));
+  EXPECT_TRUE(traversal.existsPath(id("f"), id("d"), 5));
+  EXPECT_FALSE(traversal.existsPath(id("f"), id("d"), 4));
+}
+
+}  // namespace
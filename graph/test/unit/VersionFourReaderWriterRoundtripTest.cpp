@@ -10,6 +10,7 @@
 #include "io/MCGWriter.h"
 #include "io/VersionFourMCGReader.h"
 #include "io/VersionFourMCGWriter.h"
+#include "metadata/RuntimeCallCountMD.h"
 #include "gtest/gtest.h"
 
 class V4ReaderWriterRoundtripTest : public ::testing::Test {
@@ -118,4 +119,31 @@ TEST_F(V4ReaderWriterRoundtripTest, TextGraphTextWithRefMetadata) {
   mcgWriter.writeActiveGraph(jsonSink);
 
   EXPECT_EQ(jsonSink.getJson(), jsonCG);
-}
\ No newline at end of file
+}
+TEST_F(V4ReaderWriterRoundtripTest, TextGraphTextWithEdgeMetadata) {
+  const nlohmann::json jsonCG =
+      "{\"_CG\":{\"meta\":{},\"nodes\":{\"0\":{\"callees\":{\"1\":{\"runtimeCallCount\":{\"count\":42,"
+      "\"firstSeen\":1337}}},\"functionName\":\"main\",\"hasBody\":true,\"meta\":{},\"origin\":\"main.cpp\"},"
+      "\"1\":{\"callees\":{},\"functionName\":\"foo\",\"hasBody\":true,\"meta\":{},\"origin\":\"main.cpp\"}}},"
+      "\"_MetaCG\":{\"generator\":{\"name\":\"Test\",\"sha\":\"TestSha\",\"version\":\"0.1\"},\"version\":\"4.0\"}}"_json;
+
+  metacg::io::JsonSource jsonSource(jsonCG);
+  metacg::io::VersionFourMCGReader mcgReader(jsonSource);
+  auto& mcgm = metacg::graph::MCGManager::get();
+  mcgm.addToManagedGraphs("newGraph", mcgReader.read());
+
+  const auto& cg = mcgm.getCallgraph();
+  auto* md = static_cast<metacg::RuntimeCallCountMD*>(cg->getEdgeMetaData(
+      cg->getSingleNode("main"), cg->getSingleNode("foo"), metacg::RuntimeCallCountMD::key));
+  ASSERT_NE(md, nullptr);
+  EXPECT_EQ(md->getCount(), 42);
+  EXPECT_EQ(md->getFirstSeen(), 1337);
+
+  const std::string generatorName = "Test";
+  const metacg::MCGFileInfo mcgFileInfo = {{4, 0}, {generatorName, 0, 1, "TestSha"}};
+  metacg::io::VersionFourMCGWriter mcgWriter(mcgFileInfo, false, true);
+  metacg::io::JsonSink jsonSink;
+  mcgWriter.writeActiveGraph(jsonSink);
+
+  EXPECT_EQ(jsonSink.getJson(), jsonCG);
+}
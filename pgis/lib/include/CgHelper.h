@@ -10,6 +10,7 @@
 #include "Callgraph.h"
 #include "CgNode.h"
 #include "CgTypes.h"
+#include "GraphTraversal.h"
 #include "ReachabilityAnalysis.h"
 
 #include <algorithm>  // std::set_intersection
@@ -37,6 +38,10 @@ namespace CgHelper {
 bool isConjunction(const metacg::CgNode* node, const metacg::Callgraph* const graph);
 
 metacg::CgNodeRawPtrUSet getInstrumentationPath(metacg::CgNode* start, const metacg::Callgraph* const graph);
+/**
+ * Same as above, but reuses the visited buffers of traversal across queries
+ */
+metacg::CgNodeRawPtrUSet getInstrumentationPath(metacg::CgNode* start, metacg::analysis::GraphTraversal& traversal);
 
 /**
  * Calculates the inclusive statement count for every node which is reachable from mainNode and saves in the node field
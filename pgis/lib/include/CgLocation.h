@@ -7,6 +7,11 @@
 #ifndef CGLOCATION_H
 #define CGLOCATION_H
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 class CgLocation {
  public:
   CgLocation(double time, double inclusiveTime, int threadId, int procId, unsigned long long numCalls) {
@@ -31,4 +36,78 @@ class CgLocation {
   unsigned long long numCalls;
 };
 
+/**
+ * Columnar (struct-of-arrays) storage of the per-location samples of a node.
+ * Every (process, thread) pair is assigned a dense processing unit index on first sight. The inclusive time of all
+ * non-empty samples is accumulated per processing unit on insertion, so load imbalance metrics can run over a
+ * contiguous array instead of re-aggregating the samples.
+ */
+class CgLocationTable {
+ public:
+  void push(const CgLocation& loc) {
+    const auto unit = getOrInsertUnit(loc.getProcId(), loc.getThreadId());
+    times.push_back(loc.getTime());
+    inclusiveTimes.push_back(loc.getInclusiveTime());
+    numCalls.push_back(loc.getNumCalls());
+    unitIndices.push_back(unit);
+
+    // empty (or invalid) samples do not contribute to the processing unit
+    if (loc.getInclusiveTime() > 0) {
+      unitInclusiveTimes[unit] += loc.getInclusiveTime();
+    }
+  }
+
+  inline std::size_t size() const { return times.size(); }
+  inline bool empty() const { return times.empty(); }
+
+  inline double getTime(std::size_t i) const { return times[i]; }
+  inline double getInclusiveTime(std::size_t i) const { return inclusiveTimes[i]; }
+  inline unsigned long long getNumCalls(std::size_t i) const { return numCalls[i]; }
+  inline int getProcId(std::size_t i) const { return unitProcIds[unitIndices[i]]; }
+  inline int getThreadId(std::size_t i) const { return unitThreadIds[unitIndices[i]]; }
+  inline std::uint32_t getUnitIndex(std::size_t i) const { return unitIndices[i]; }
+
+  CgLocation operator[](std::size_t i) const {
+    return {getTime(i), getInclusiveTime(i), getThreadId(i), getProcId(i), getNumCalls(i)};
+  }
+
+  /**
+   * Number of distinct (process, thread) pairs seen so far
+   */
+  inline std::size_t getNumProcessingUnits() const { return unitInclusiveTimes.size(); }
+  inline int getUnitProcId(std::uint32_t unit) const { return unitProcIds[unit]; }
+  inline int getUnitThreadId(std::uint32_t unit) const { return unitThreadIds[unit]; }
+
+  /**
+   * Accumulated inclusive time of the non-empty samples, indexed by processing unit.
+   * A value of zero denotes a processing unit without any non-empty sample.
+   */
+  inline const std::vector<double>& getInclusiveTimePerUnit() const { return unitInclusiveTimes; }
+
+ private:
+  std::uint32_t getOrInsertUnit(int procId, int threadId) {
+    const auto key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(procId)) << 32) |
+                     static_cast<std::uint32_t>(threadId);
+    const auto [it, inserted] = unitLookup.try_emplace(key, static_cast<std::uint32_t>(unitInclusiveTimes.size()));
+    if (inserted) {
+      unitProcIds.push_back(procId);
+      unitThreadIds.push_back(threadId);
+      unitInclusiveTimes.push_back(.0);
+    }
+    return it->second;
+  }
+
+  // per sample
+  std::vector<double> times;
+  std::vector<double> inclusiveTimes;
+  std::vector<unsigned long long> numCalls;
+  std::vector<std::uint32_t> unitIndices;
+
+  // per processing unit
+  std::vector<int> unitProcIds;
+  std::vector<int> unitThreadIds;
+  std::vector<double> unitInclusiveTimes;
+  std::unordered_map<std::uint64_t, std::uint32_t> unitLookup;
+};
+
 #endif  // CGLOCATION_H
@@ -22,12 +22,14 @@
 
 #include "cxxabi.h"
 
+#include "CgNode.h"
 #include "ExtrapAggregatedFunctions.h"
 #include "LoggerUtil.h"
 #include "config/PiraIIConfig.h"
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -53,15 +55,36 @@ struct ExtrapConfig {
 
 class ExtrapExtrapolator {
  public:
+  using ExtrapolationPoint = std::vector<std::pair<std::string, double>>;
+
   explicit ExtrapExtrapolator(std::vector<std::pair<std::string, std::vector<int>>> values)
-      : values(std::move(values)) {}
+      : values(std::make_shared<const std::vector<std::pair<std::string, std::vector<int>>>>(std::move(values))),
+        extrapolationPoint(std::make_shared<const ExtrapolationPoint>(computeExtrapolationValue(*this->values, 1.0))) {}
+
+  const auto& getValues() const { return *values; }
 
-  auto getValues() { return values; }
+  /**
+   * The extrapolation point for the default step width. Computed once per configuration, copies of the extrapolator
+   * share it.
+   */
+  const ExtrapolationPoint& getExtrapolationPoint() const { return *extrapolationPoint; }
 
-  auto getExtrapolationValue(double alpha = 1.0) {
-    std::vector<std::pair<std::string, double>> result;
+  ExtrapolationPoint getExtrapolationValue(double alpha = 1.0) const {
+    if (alpha == 1.0) {
+      return *extrapolationPoint;
+    }
+    return computeExtrapolationValue(*values, alpha);
+  }
+
+ private:
+  static ExtrapolationPoint computeExtrapolationValue(
+      const std::vector<std::pair<std::string, std::vector<int>>>& values, double alpha) {
+    ExtrapolationPoint result;
     // We need to compute extrapolation values for all params
     for (const auto& param_pair : values) {
+      if (param_pair.second.empty()) {
+        continue;
+      }
       std::vector<double> steps;
       auto it1 = param_pair.second.begin();
       auto it2 = param_pair.second.begin();
@@ -80,9 +103,9 @@ class ExtrapExtrapolator {
     return result;
   }
 
- private:
   // static ExtrapExtrapolator *instance;
-  std::vector<std::pair<std::string, std::vector<int>>> values;
+  std::shared_ptr<const std::vector<std::pair<std::string, std::vector<int>>>> values;
+  std::shared_ptr<const ExtrapolationPoint> extrapolationPoint;
 };
 
 /* Utility functions to read in configuration and print it */
@@ -112,7 +135,7 @@ class ExtrapConnector {
   ~ExtrapConnector() = default;
 
   ExtrapConnector(const ExtrapConnector& other)
-      : epModelFunction(std::make_unique<EXTRAP::Function>(*other.epModelFunction)),
+      : epModelFunction(other.epModelFunction ? std::make_unique<EXTRAP::Function>(*other.epModelFunction) : nullptr),
         models(other.models),
         paramList(other.paramList),
         epolator(other.epolator) {
@@ -121,7 +144,8 @@ class ExtrapConnector {
   }
 
   ExtrapConnector& operator=(const ExtrapConnector& other) {
-    this->epModelFunction = std::make_unique<EXTRAP::Function>(*other.epModelFunction);
+    this->epModelFunction =
+        other.epModelFunction ? std::make_unique<EXTRAP::Function>(*other.epModelFunction) : nullptr;
     this->models = other.models;
     this->paramList = other.paramList;
     this->epolator = other.epolator;
@@ -159,8 +183,8 @@ class ExtrapConnector {
       return "not set!";
     }
   }
-  auto getParamList() const { return this->paramList; }
-  auto getEpolator() const { return epolator; }
+  const auto& getParamList() const { return this->paramList; }
+  const auto& getEpolator() const { return epolator; }
 
   /* Set the specific model */
   void setEpolator(ExtrapExtrapolator e) { epolator = e; }
@@ -183,7 +207,8 @@ class ExtrapConnector {
 
 class ExtrapModelProvider {
  public:
-  explicit ExtrapModelProvider(ExtrapConfig config) : config(std::move(config)), experiment(nullptr) {}
+  explicit ExtrapModelProvider(ExtrapConfig config)
+      : config(std::move(config)), experiment(nullptr), epolator(this->config.params) {}
   ~ExtrapModelProvider() {
     if (experiment) {
       auto generators = experiment->getModelGenerators();
@@ -198,19 +223,30 @@ class ExtrapModelProvider {
       buildModels();
     }
 
-    // PGIS uses mangled names, Extra-P apparently demangled names.
-    // XXX This may have changed in libcube 4.5? Double Check!
-    auto demangledName = demangle(functionName);
-
-    auto paramList = getParameterList();
+    static const std::vector<EXTRAP::Model*> noModels;
+    const auto it = models.find(functionName);
+    const auto& m = it != models.end() ? it->second : noModels;
 
-    auto m = models[functionName];
-    metacg::MCGLogger::instance().getConsole()->debug(
-        "ModelProvider:getModelFor {}: {}\nUsing mangled name: {}", demangledName,
-        m.size() > 0 ? m.front()->getModelFunction()->getAsString(getParameterList()) : " NONE ", functionName);
+    auto console = metacg::MCGLogger::instance().getConsole();
+    if (console->should_log(spdlog::level::debug)) {
+      // PGIS uses mangled names, Extra-P apparently demangled names.
+      // XXX This may have changed in libcube 4.5? Double Check!
+      console->debug("ModelProvider:getModelFor {}: {}\nUsing mangled name: {}", demangle(functionName),
+                     m.size() > 0 ? m.front()->getModelFunction()->getAsString(paramList) : " NONE ", functionName);
+    }
     return ExtrapConnector(m, paramList);
   }
 
+  /**
+   * Cached variant of getModelFor: the connector of a node is built on first request and reused afterwards.
+   */
+  const ExtrapConnector& getModelFor(const metacg::CgNode& node) {
+    if (const auto it = connectorCache.find(node.getId()); it != connectorCache.end()) {
+      return it->second;
+    }
+    return connectorCache.emplace(node.getId(), getModelFor(node.getFunctionName())).first->second;
+  }
+
   std::vector<EXTRAP::Parameter> getParameterList();
 
   std::vector<double> getConfigValues(const std::string& key) {
@@ -229,13 +265,22 @@ class ExtrapModelProvider {
 
   auto getConfigValues() const { return config.params; }
 
+  /**
+   * Extrapolator for the current configuration. Its extrapolation point is computed once and shared by all copies.
+   */
+  const ExtrapExtrapolator& getExtrapolator() const { return epolator; }
+
   void buildModels();
 
  private:
   ExtrapConfig config;
   // Hold mapping mangled_name -> Models
   std::unordered_map<std::string, std::vector<EXTRAP::Model*>> models;
+  // Connectors handed out per node, see getModelFor(const CgNode&)
+  std::unordered_map<metacg::NodeId, ExtrapConnector> connectorCache;
+  EXTRAP::ParameterList paramList;
   EXTRAP::Experiment* experiment;
+  ExtrapExtrapolator epolator;
 };
 
 }  // namespace extrapconnection
@@ -24,6 +24,9 @@
 #include "EXTRAP_SingleParameterFunction.hpp"
 #pragma GCC diagnostic pop
 
+#include <cmath>
+#include <optional>
+
 namespace pira {
 
 template <typename ContT1, typename ContT2>
@@ -88,11 +91,31 @@ class ExtrapLocalEstimatorPhaseBase : public EstimatorPhase {
   template <typename... Vals>
   value_type evalModelWValue(metacg::CgNode* n, Vals... values) const;
   */
-  auto evalModelWValue(metacg::CgNode* n, std::vector<std::pair<std::string, double>> values) const;
+  auto evalModelWValue(metacg::CgNode* n, const std::vector<std::pair<std::string, double>>& values) const;
+
+  /**
+   * Evaluates the models of all nodes at their extrapolation point in one batch, which runs in parallel across nodes.
+   * The results are cached per NodeId and used by shouldInstrument.
+   */
+  void evaluateModels();
+
+  /**
+   * Model value computed by the last call to evaluateModels, if any
+   */
+  std::optional<value_type> getCachedModelValue(metacg::NodeId id) const {
+    if (id < modelValues.size() && !std::isnan(modelValues[id])) {
+      return modelValues[id];
+    }
+    return std::nullopt;
+  }
+
   bool allNodesToMain;
   bool useRuntimeOnly;
 
   std::vector<std::pair<double, metacg::CgNode*>> kernels;
+
+  // Indexed by NodeId, NaN if no model value is available
+  std::vector<value_type> modelValues;
 };
 
 #if 0
@@ -112,7 +135,7 @@ ExtrapLocalEstimatorPhaseBase::value_type ExtrapLocalEstimatorPhaseBase::evalMod
 #endif
 
 auto ExtrapLocalEstimatorPhaseBase::evalModelWValue(metacg::CgNode* n,
-                                                    std::vector<std::pair<std::string, double>> values) const {
+                                                    const std::vector<std::pair<std::string, double>>& values) const {
   auto& fModel = n->get<PiraTwoData>()->getExtrapModelConnector().getEPModelFunction();
 
   std::map<EXTRAP::Parameter, double> evalOps;
@@ -0,0 +1,103 @@
+/**
+ * File: Histogram.h
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#ifndef PGIS_HISTOGRAM_H
+#define PGIS_HISTOGRAM_H
+
+#include <cstddef>
+#include <map>
+
+namespace metacg::pgis {
+
+/**
+ * Mergeable quantile sketch with bounded relative error.
+ * Values are mapped to logarithmically spaced buckets, so the number of buckets grows with the logarithm of the value
+ * range instead of the number of distinct values. Sketches with the same accuracy can be merged losslessly.
+ */
+class QuantileSketch {
+ public:
+  explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+  void add(double value, long int count = 1);
+  /**
+   * Adds the buckets of other to this sketch. Both sketches need to be created with the same accuracy.
+   */
+  void merge(const QuantileSketch& other);
+
+  /**
+   * Estimate of the value at rank floor(q * count), q in [0, 1]. Returns 0 for an empty sketch.
+   */
+  double getQuantile(double q) const;
+
+  inline bool empty() const { return count == 0; }
+  inline long int getCount() const { return count; }
+  inline double getRelativeAccuracy() const { return relativeAccuracy; }
+  inline std::size_t getNumBuckets() const { return positiveBuckets.size() + negativeBuckets.size(); }
+
+ private:
+  int indexOf(double value) const;
+  double valueOf(int index) const;
+
+  double relativeAccuracy;
+  double gamma;
+  double logGamma;
+  // bucket index -> count, keyed by the index of the absolute value
+  std::map<int, long int> positiveBuckets;
+  std::map<int, long int> negativeBuckets;
+  long int zeroCount{0};
+  long int count{0};
+};
+
+/**
+ * Exact histogram over integral values.
+ * All rank queries walk the cumulative bucket counts, i.e., they run in O(buckets) time and memory independent of the
+ * number of samples.
+ */
+class Histogram {
+ public:
+  using ValueT = long int;
+  using CountT = long int;
+  using BucketMap = std::map<ValueT, CountT>;
+  using const_iterator = BucketMap::const_iterator;
+
+  void add(ValueT value, CountT count = 1);
+  void merge(const Histogram& other);
+
+  inline bool empty() const { return buckets.empty(); }
+  inline std::size_t getNumBuckets() const { return buckets.size(); }
+  inline CountT getTotalCount() const { return totalCount; }
+  inline const_iterator begin() const { return buckets.begin(); }
+  inline const_iterator end() const { return buckets.end(); }
+
+  /**
+   * The queries below return 0 for an empty histogram.
+   */
+  ValueT getMin() const;
+  ValueT getMax() const;
+  /** Half of the largest value */
+  ValueT getHalfMax() const;
+  /** Median weighted by the bucket counts, i.e., the value at rank count / 2 */
+  ValueT getMedian() const;
+  /** Median of the distinct values, ignoring the bucket counts */
+  ValueT getUniqueMedian() const;
+  /** Value at rank floor(p * count), p in [0, 1]. getPercentile(.5) equals getMedian(). */
+  ValueT getPercentile(double p) const;
+
+  /**
+   * Approximate representation for combining histograms of very large graphs
+   */
+  QuantileSketch toSketch(double relativeAccuracy = 0.01) const;
+
+ private:
+  ValueT getValueAtRank(CountT rank) const;
+
+  BucketMap buckets;
+  CountT totalCount{0};
+};
+
+}  // namespace metacg::pgis
+
+#endif  // PGIS_HISTOGRAM_H
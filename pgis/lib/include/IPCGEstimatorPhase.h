@@ -8,6 +8,7 @@
 #define IPCGESTIMATORPHASE_H_
 
 #include "EstimatorPhase.h"
+#include "Histogram.h"
 #include "MetaData/CgNodeMetaData.h"
 
 #include <map>
@@ -83,27 +84,36 @@ class StatisticsEstimatorPhase : public EstimatorPhase {
   long int getCuttoffLoopDepth() const;
   long int getCuttoffGlobalLoopDepth() const;
 
+  /**
+   * The histograms the cut-off values are selected from, e.g., to derive percentile-based thresholds
+   */
+  const metacg::pgis::Histogram& getNumStmtsHistogram() const { return stmtHist; }
+  const metacg::pgis::Histogram& getNumInclStmtsHistogram() const { return stmtInclHist; }
+  const metacg::pgis::Histogram& getReverseConditionalBranchesHistogram() const {
+    return reverseConditionalBranchesInclHist;
+  }
+  const metacg::pgis::Histogram& getConditionalBranchesHistogram() const { return conditionalBranchesInclHist; }
+  const metacg::pgis::Histogram& getRooflineHistogram() const { return rooflineInclHist; }
+  const metacg::pgis::Histogram& getLoopDepthHistogram() const { return loopDepthInclHist; }
+  const metacg::pgis::Histogram& getGlobalLoopDepthHistogram() const { return globalLoopDepthInclHist; }
+
  private:
-  using MapT = std::map<long int, long int>;
-  long int getCuttoffValue(const MapT& hist) const;
-  long int getUniqueMedianFromHist(const MapT& hist) const;
-  long int getMedianFromHist(const MapT& hist) const;
-  long int getHalfMaxFromHist(const MapT& hist) const;
-  std::string printHist(const MapT& hist, const std::string& name);
+  long int getCuttoffValue(const metacg::pgis::Histogram& hist) const;
+  static std::string printHist(const metacg::pgis::Histogram& hist, const std::string& name);
   bool shouldPrintReport;
   long int numFunctions;
   long int numReachableFunctions;
   long int totalStmts;
-  MapT stmtHist;
-  MapT stmtInclHist;
+  metacg::pgis::Histogram stmtHist;
+  metacg::pgis::Histogram stmtInclHist;
   long int stmtsCoveredWithInstr;
   long int stmtsActuallyCovered;
   long int totalVarDecls;
-  MapT conditionalBranchesInclHist;
-  MapT reverseConditionalBranchesInclHist;
-  MapT rooflineInclHist;
-  MapT loopDepthInclHist;
-  MapT globalLoopDepthInclHist;
+  metacg::pgis::Histogram conditionalBranchesInclHist;
+  metacg::pgis::Histogram reverseConditionalBranchesInclHist;
+  metacg::pgis::Histogram rooflineInclHist;
+  metacg::pgis::Histogram loopDepthInclHist;
+  metacg::pgis::Histogram globalLoopDepthInclHist;
 };
 
 /**
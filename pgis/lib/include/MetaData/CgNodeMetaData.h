@@ -106,7 +106,7 @@ public:
    this->inclTimeInSeconds += inclusiveTimeInSeconds;
    this->threadId = threadId;
    this->processId = procId;
-   this->cgLoc.emplace_back(CgLocation(timeInSeconds, inclusiveTimeInSeconds, threadId, procId, calls));
+   this->cgLoc.push(CgLocation(timeInSeconds, inclusiveTimeInSeconds, threadId, procId, calls));
  }
  unsigned long long getNumberOfCalls() const { return this->numCalls; }
  void setNumberOfCalls(unsigned long long nrCall) { this->numCalls = nrCall; }
@@ -152,9 +152,9 @@ public:
 
  void addNumberOfCallsFrom(metacg::CgNode* parentNode, unsigned long long calls) { callFrom[parentNode] += calls; }
 
- const std::vector<CgLocation>& getCgLocation() const { return cgLoc; }
+ const CgLocationTable& getCgLocation() const { return cgLoc; }
 
- void pushCgLocation(CgLocation toPush) { this->cgLoc.push_back(toPush); }
+ void pushCgLocation(const CgLocation& toPush) { this->cgLoc.push(toPush); }
 
 private:
  unsigned long long numCalls{0};
@@ -163,7 +163,7 @@ private:
  int threadId{0};
  int processId{0};
  std::unordered_map<metacg::CgNode*, unsigned long long> callFrom;
- std::vector<CgLocation> cgLoc;
+ CgLocationTable cgLoc;
 };
 
 /**
@@ -13,10 +13,13 @@
 
 #include "MetaData/PGISMetaData.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <string>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 namespace utils {
 namespace string {
@@ -70,6 +73,36 @@ auto valTup(C1 co, C2 ct, int numReps) {
   return res;
 }
 
+/**
+ * Calls fn(i) for every i in [0, numItems), distributing contiguous chunks of indices across worker threads.
+ * fn must be safe to run concurrently for distinct indices.
+ */
+template <typename Fn>
+void parallelFor(std::size_t numItems, Fn&& fn) {
+  const std::size_t numThreads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), numItems);
+  if (numThreads <= 1) {
+    for (std::size_t i = 0; i < numItems; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  const std::size_t chunkSize = (numItems + numThreads - 1) / numThreads;
+  std::vector<std::thread> workers;
+  workers.reserve(numThreads);
+  for (std::size_t begin = 0; begin < numItems; begin += chunkSize) {
+    const std::size_t end = std::min(begin + chunkSize, numItems);
+    workers.emplace_back([&fn, begin, end]() {
+      for (std::size_t i = begin; i < end; ++i) {
+        fn(i);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
 }  // namespace utils
 
 inline bool isEligibleForPathInstrumentation(metacg::CgNode* node, metacg::Callgraph* graph,
@@ -8,6 +8,7 @@
 #define LI_ESTIMATORPHASE_H
 
 #include "EstimatorPhase.h"
+#include "GraphTraversal.h"
 #include "LIConfig.h"
 #include "loadImbalance/metric/AbstractMetric.h"
 
@@ -37,6 +38,11 @@ class LIEstimatorPhase : public EstimatorPhase {
    */
   std::unique_ptr<LIConfig> c;
 
+  /**
+   * Reused by all local walks to avoid per-query allocations
+   */
+  metacg::analysis::GraphTraversal traversal;
+
   // utility functions
   // =================
   /**
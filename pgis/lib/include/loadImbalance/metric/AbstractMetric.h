@@ -8,10 +8,28 @@
 #define LI_ABSTRACT_METRIC_H
 
 #include "../../../../../graph/include/CgNode.h"
+#include <cstddef>
 #include <sstream>
 
 namespace LoadImbalance {
 
+/**
+ * Standard statistical indicators over the non-empty (> 0) entries of a series of values
+ */
+struct Indicators {
+  double max{.0};
+  double min{.0};
+  double mean{.0};
+  double stdev{.0};
+  int count{0};
+};
+
+/**
+ * Computes all indicators in a single vectorizable pass over a contiguous array of values.
+ * Entries <= 0 are treated as empty and ignored.
+ */
+Indicators computeIndicators(const double* values, std::size_t numValues);
+
 /**
  * Base class for load imbalance metrics.
  * Provides standard interface which is used by LIEstimatorPhase.
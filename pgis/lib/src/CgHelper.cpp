@@ -25,26 +25,22 @@ bool isConjunction(const metacg::CgNode* node, const metacg::Callgraph* const gr
  *  It should not break for cycles, because cycles have to be instrumented by
  * definition. */
 CgNodeRawPtrUSet getInstrumentationPath(metacg::CgNode* start, const metacg::Callgraph* const graph) {
-  CgNodeRawPtrUSet path;  // visited nodes
-  std::queue<metacg::CgNode*> workQueue;
-  workQueue.push(start);
-  while (!workQueue.empty()) {
-    auto node = workQueue.front();
-    workQueue.pop();
-    if (path.find(node) == path.end()) {
-      path.insert(node);
-      if (metacg::pgis::isInstrumented(node) || metacg::pgis::isInstrumentedPath(node) ||
-          /*node.isRootNode()*/ graph->getCallers(*node).empty()) {
-        continue;
-      }
-
-      for (auto parentNode : graph->getCallers(*node)) {
-        workQueue.push(parentNode);
-      }
-    }
-  }
+  metacg::analysis::GraphTraversal traversal(graph);
+  return getInstrumentationPath(start, traversal);
+}
 
-  return {path.begin(), path.end()};
+CgNodeRawPtrUSet getInstrumentationPath(metacg::CgNode* start, metacg::analysis::GraphTraversal& traversal) {
+  CgNodeRawPtrUSet path;  // visited nodes
+  traversal.bfs(start->getId(), metacg::analysis::TraversalDirection::Callers,
+                metacg::analysis::GraphTraversal::Unbounded, [&](metacg::CgNode* node, unsigned) {
+                  path.insert(node);
+                  // Root nodes have no callers to expand anyway
+                  if (metacg::pgis::isInstrumented(node) || metacg::pgis::isInstrumentedPath(node)) {
+                    return metacg::analysis::VisitResult::Prune;
+                  }
+                  return metacg::analysis::VisitResult::Continue;
+                });
+  return path;
 }
 
 Statements visitNodeForInclusiveStatements(metacg::CgNode* node, CgNodeRawPtrUSet* visitedNodes,
@@ -7,6 +7,7 @@
 #include "ExtrapConnection.h"
 #include "CubeReader.h"
 #include "ErrorCodes.h"
+#include "Utility.h"
 
 #include "nlohmann/json.hpp"
 #include <filesystem>
@@ -133,6 +134,8 @@ void ExtrapModelProvider::buildModels() {
   EXTRAP::CubeFileReader reader;
 
   auto extrapParams = getParameterList();
+  paramList = extrapParams;
+  connectorCache.clear();
 
   const int scalingType = static_cast<int>(ExtraPScalingType::weak);
 
@@ -252,26 +255,42 @@ void ExtrapModelProvider::buildModels() {
   auto callPaths = experiment->getAllCallpaths();
   auto metrics = experiment->getMetrics();
 
-  // Retrieve the actual models for the given regions and call paths
-  for (const auto& cp : callPaths) {
-    for (const auto& m : metrics) {
-      if (m->getName() != "time") {
-        continue;
-      }
-      console->debug("Processing for {}", cp->getRegion()->getName());
-      auto functionModels = experiment->getModels(*m, *cp);
-
-      for (auto i : functionModels) {
-        if (i == nullptr) {
-          errConsole->warn("Function model is NULL");
-          assert(false && "the function model should not be nullptr");
-          // What happened if it is indeed nullptr?
-        }
-        console->debug("{} >>>> {}", cp->getRegion()->getName(), i->getModelFunction()->getAsString(extrapParams));
+  // Retrieve the actual models for the given regions and call paths.
+  // The call paths are processed concurrently into per-call-path slots, which are then merged in call path order. This
+  // keeps the order of the models per function, and thus the result of the aggregation strategies, deterministic.
+  EXTRAP::Metric* timeMetric = nullptr;
+  for (const auto& m : metrics) {
+    if (m->getName() == "time") {
+      timeMetric = m;
+      break;
+    }
+  }
+  if (!timeMetric) {
+    errConsole->warn("No time metric found in the experiment.");
+    return;
+  }
+
+  std::vector<std::vector<EXTRAP::Model*>> callPathModels(callPaths.size());
+  const bool logModels = console->should_log(spdlog::level::debug);
+  utils::parallelFor(callPaths.size(), [&](std::size_t i) {
+    const auto& cp = callPaths[i];
+    auto functionModels = experiment->getModels(*timeMetric, *cp);
+
+    for (auto model : functionModels) {
+      if (model == nullptr) {
+        errConsole->warn("Function model is NULL");
+        assert(false && "the function model should not be nullptr");
+        // What happened if it is indeed nullptr?
+      } else if (logModels) {
+        console->debug("{} >>>> {}", cp->getRegion()->getName(), model->getModelFunction()->getAsString(extrapParams));
       }
-      auto& elem = models[cp->getRegion()->getName()];
-      elem.insert(elem.end(), std::begin(functionModels), std::end(functionModels));
     }
+    callPathModels[i] = std::move(functionModels);
+  });
+
+  for (std::size_t i = 0; i < callPaths.size(); ++i) {
+    auto& elem = models[callPaths[i]->getRegion()->getName()];
+    elem.insert(elem.end(), std::begin(callPathModels[i]), std::end(callPathModels[i]));
   }
 
   console->info("Finished model creation.");
@@ -13,12 +13,14 @@
 
 #include "IPCGEstimatorPhase.h"
 #include "MetaData/PGISMetaData.h"
+#include "Utility.h"
 
 #include "EXTRAP_Function.hpp"
 #include "EXTRAP_Model.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <sstream>
 
 using namespace metacg;
@@ -30,6 +32,8 @@ void ExtrapLocalEstimatorPhaseBase::modifyGraph(metacg::CgNode* mainNode) {
   console->trace("Running ExtrapLocalEstimatorPhaseBase::modifyGraph");
   metacg::analysis::ReachabilityAnalysis ra(graph);
 
+  evaluateModels();
+
   for (const auto& elem : graph->getNodes()) {
     const auto& n = elem.get();
     auto [shouldInstr, funcRtVal] = shouldInstrument(n);
@@ -75,6 +79,24 @@ void ExtrapLocalEstimatorPhaseBase::printReport() {
   console->info("$$ Identified Kernels (w/ Runtime) $$\n{}$$ End Kernels $$", ss.str());
 }
 
+void ExtrapLocalEstimatorPhaseBase::evaluateModels() {
+  const auto& nodes = graph->getNodes();
+  modelValues.assign(nodes.size(), std::numeric_limits<value_type>::quiet_NaN());
+
+  // Only reads the (already attached) models, every node writes its own slot.
+  utils::parallelFor(nodes.size(), [&](std::size_t i) {
+    const auto n = nodes[i].get();
+    if (!n || !n->has<PiraTwoData>()) {
+      return;
+    }
+    const auto& epCon = n->get<PiraTwoData>()->getExtrapModelConnector();
+    if (!epCon.isModelSet()) {
+      return;
+    }
+    modelValues[i] = evalModelWValue(n, epCon.getEpolator().getExtrapolationPoint());
+  });
+}
+
 std::pair<bool, double> ExtrapLocalEstimatorPhaseBase::shouldInstrument(metacg::CgNode* node) const {
   assert(false && "Base class should not be instantiated.");
   return {false, -1};
@@ -118,9 +140,10 @@ std::pair<bool, double> ExtrapLocalEstimatorPhaseSingleValueFilter::shouldInstru
     return {false, -1};
   }
 
-  auto modelValue = node->get<PiraTwoData>()->getExtrapModelConnector().getEpolator().getExtrapolationValue();
+  const auto& modelValue = node->get<PiraTwoData>()->getExtrapModelConnector().getEpolator().getExtrapolationPoint();
 
-  auto fVal = evalModelWValue(node, modelValue);
+  const auto cachedValue = getCachedModelValue(node->getId());
+  const auto fVal = cachedValue ? *cachedValue : evalModelWValue(node, modelValue);
 
   console->debug("Model value for function {} is calcuated at x = {} as {}", node->getFunctionName(),
                  modelValue[0].second, fVal);
@@ -135,6 +158,8 @@ void ExtrapLocalEstimatorPhaseSingleValueExpander::modifyGraph(metacg::CgNode* m
   // get statement threshold from parameter configPtr
   const int statementThreshold = pgis::config::ParameterConfig::get().getPiraIIConfig()->statementThreshold;
 
+  evaluateModels();
+
   for (const auto& elem : graph->getNodes()) {
     const auto& n = elem.get();
     auto console = metacg::MCGLogger::instance().getConsole();
@@ -0,0 +1,147 @@
+/**
+ * File: Histogram.cpp
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace metacg::pgis {
+
+// QUANTILE SKETCH
+
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+    : relativeAccuracy(relativeAccuracy),
+      gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)),
+      logGamma(std::log(gamma)) {}
+
+int QuantileSketch::indexOf(double value) const { return static_cast<int>(std::ceil(std::log(value) / logGamma)); }
+
+double QuantileSketch::valueOf(int index) const { return 2.0 * std::pow(gamma, index) / (gamma + 1.0); }
+
+void QuantileSketch::add(double value, long int count) {
+  if (count <= 0) {
+    return;
+  }
+  if (value > 0) {
+    positiveBuckets[indexOf(value)] += count;
+  } else if (value < 0) {
+    negativeBuckets[indexOf(-value)] += count;
+  } else {
+    zeroCount += count;
+  }
+  this->count += count;
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  if (other.gamma != gamma) {
+    // Different bucket boundaries: fall back to re-inserting the representative values
+    for (const auto& [index, bucketCount] : other.positiveBuckets) {
+      add(other.valueOf(index), bucketCount);
+    }
+    for (const auto& [index, bucketCount] : other.negativeBuckets) {
+      add(-other.valueOf(index), bucketCount);
+    }
+    add(.0, other.zeroCount);
+    return;
+  }
+  for (const auto& [index, bucketCount] : other.positiveBuckets) {
+    positiveBuckets[index] += bucketCount;
+  }
+  for (const auto& [index, bucketCount] : other.negativeBuckets) {
+    negativeBuckets[index] += bucketCount;
+  }
+  zeroCount += other.zeroCount;
+  count += other.count;
+}
+
+double QuantileSketch::getQuantile(double q) const {
+  if (empty()) {
+    return .0;
+  }
+  const auto rank = std::min(count - 1, static_cast<long int>(std::clamp(q, .0, 1.0) * static_cast<double>(count)));
+
+  long int seen = 0;
+  // Largest absolute index is the smallest value
+  for (auto it = negativeBuckets.rbegin(); it != negativeBuckets.rend(); ++it) {
+    seen += it->second;
+    if (seen > rank) {
+      return -valueOf(it->first);
+    }
+  }
+  seen += zeroCount;
+  if (seen > rank) {
+    return .0;
+  }
+  for (const auto& [index, bucketCount] : positiveBuckets) {
+    seen += bucketCount;
+    if (seen > rank) {
+      return valueOf(index);
+    }
+  }
+  return valueOf(positiveBuckets.rbegin()->first);
+}
+
+// HISTOGRAM
+
+void Histogram::add(ValueT value, CountT count) {
+  if (count <= 0) {
+    return;
+  }
+  buckets[value] += count;
+  totalCount += count;
+}
+
+void Histogram::merge(const Histogram& other) {
+  for (const auto& [value, count] : other.buckets) {
+    buckets[value] += count;
+  }
+  totalCount += other.totalCount;
+}
+
+Histogram::ValueT Histogram::getMin() const { return empty() ? 0 : buckets.begin()->first; }
+
+Histogram::ValueT Histogram::getMax() const { return empty() ? 0 : buckets.rbegin()->first; }
+
+Histogram::ValueT Histogram::getHalfMax() const { return getMax() >> 1; }
+
+Histogram::ValueT Histogram::getMedian() const { return getValueAtRank(totalCount / 2); }
+
+Histogram::ValueT Histogram::getUniqueMedian() const {
+  if (empty()) {
+    return 0;
+  }
+  return std::next(buckets.begin(), static_cast<long int>(buckets.size() / 2))->first;
+}
+
+Histogram::ValueT Histogram::getPercentile(double p) const {
+  return getValueAtRank(static_cast<CountT>(std::clamp(p, .0, 1.0) * static_cast<double>(totalCount)));
+}
+
+Histogram::ValueT Histogram::getValueAtRank(CountT rank) const {
+  if (empty()) {
+    return 0;
+  }
+  CountT seen = 0;
+  for (const auto& [value, count] : buckets) {
+    seen += count;
+    if (seen > rank) {
+      return value;
+    }
+  }
+  return getMax();
+}
+
+QuantileSketch Histogram::toSketch(double relativeAccuracy) const {
+  QuantileSketch sketch(relativeAccuracy);
+  for (const auto& [value, count] : buckets) {
+    sketch.add(static_cast<double>(value), count);
+  }
+  return sketch;
+}
+
+}  // namespace metacg::pgis
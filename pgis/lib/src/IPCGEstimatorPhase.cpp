@@ -7,6 +7,7 @@
 #include "ReachabilityAnalysis.h"
 
 #include "CgHelper.h"
+#include "GraphTraversal.h"
 #include "IPCGEstimatorPhase.h"
 #include "MetaData/CgNodeMetaData.h"
 #include "MetaData/PGISMetaData.h"
@@ -900,11 +901,9 @@ void StatisticsEstimatorPhase::modifyGraph(metacg::CgNode* mainMethod) {
     if (node->getOrCreate<PiraOneData>().comesFromCube()) {
       stmtsActuallyCovered += numStmts;
     }
-    auto& histElem = stmtHist[numStmts];
-    histElem++;
+    stmtHist.add(numStmts);
     totalStmts += numStmts;
-    auto& inclHistElem = stmtInclHist[sce.getNumStatements(node)];
-    inclHistElem++;
+    stmtInclHist.add(sce.getNumStatements(node));
 
     if (node->has<CodeStatisticsMD>()) {
       const auto csMD = node->get<CodeStatisticsMD>();
@@ -921,32 +920,12 @@ void StatisticsEstimatorPhase::printReport() {
     return;
   }
 
-  const auto toRandAccContainer = [&](decltype(stmtHist)& inCont) {
-    std::vector<std::remove_reference<decltype(inCont)>::type::key_type> keys;
-    for (const auto& n : inCont) {
-      keys.push_back(n.first);
-    }
-    return keys;
-  };
-
-  auto singleStmts = toRandAccContainer(stmtHist);
-  std::nth_element(singleStmts.begin(), singleStmts.begin() + singleStmts.size() / 2, singleStmts.end());
-  long int medianNumSingleStmts = singleStmts[singleStmts.size() / 2];
-
-  auto inclStmts = toRandAccContainer(stmtInclHist);
-  std::nth_element(inclStmts.begin(), inclStmts.begin() + inclStmts.size() / 2, inclStmts.end());
-
-  const long int medianNumStmts = inclStmts[inclStmts.size() / 2];
-
-  using HP = decltype(stmtHist)::value_type;
-  auto minMax = std::minmax_element(stmtHist.begin(), stmtHist.end(), [](HP p1, HP p2) { return p1.first < p2.first; });
-  const long int maxNumSingleStmts = (*(minMax.second)).first;
-  const long int minNumSingleStmts = (*(minMax.first)).first;
-
-  auto minMaxIncl =
-      std::minmax_element(stmtInclHist.begin(), stmtInclHist.end(), [](HP p1, HP p2) { return p1.first < p2.first; });
-  const long int maxNumStmts = (*(minMaxIncl.second)).first;
-  const long int minNumStmts = (*(minMaxIncl.first)).first;
+  const long int medianNumSingleStmts = stmtHist.getUniqueMedian();
+  const long int medianNumStmts = stmtInclHist.getUniqueMedian();
+  const long int maxNumSingleStmts = stmtHist.getMax();
+  const long int minNumSingleStmts = stmtHist.getMin();
+  const long int maxNumStmts = stmtInclHist.getMax();
+  const long int minNumStmts = stmtInclHist.getMin();
 
   auto console = metacg::MCGLogger::instance().getConsole();
   console->info(
@@ -982,7 +961,7 @@ void StatisticsEstimatorPhase::printReport() {
   console->info(printHist(globalLoopDepthInclHist, "globalLoopDepth"));
 }
 
-std::string StatisticsEstimatorPhase::printHist(const MapT& hist, const std::string& name) {
+std::string StatisticsEstimatorPhase::printHist(const metacg::pgis::Histogram& hist, const std::string& name) {
   std::string out;
   out += "Histogram for " + name + ":\n";
   for (const auto& entry : hist) {
@@ -991,78 +970,32 @@ std::string StatisticsEstimatorPhase::printHist(const MapT& hist, const std::str
   if (hist.empty()) {
     return out;  // Fast exit for empty histogram
   }
-  out += "Metric: Max: " + std::to_string(getHalfMaxFromHist(hist)) + "\n";
-  out += "Metric: Median: " + std::to_string(getMedianFromHist(hist)) + "\n";
-  out += "Metric: Unique Median: " + std::to_string(getUniqueMedianFromHist(hist)) + "\n";
+  out += "Metric: Max: " + std::to_string(hist.getHalfMax()) + "\n";
+  out += "Metric: Median: " + std::to_string(hist.getMedian()) + "\n";
+  out += "Metric: Unique Median: " + std::to_string(hist.getUniqueMedian()) + "\n";
   return out;
 }
 
 long int StatisticsEstimatorPhase::getCuttoffNumInclStmts() { return getCuttoffValue(stmtInclHist); }
 
-long int StatisticsEstimatorPhase::getCuttoffValue(const MapT& hist) const {
+long int StatisticsEstimatorPhase::getCuttoffValue(const metacg::pgis::Histogram& hist) const {
   if (hist.empty()) {
-    return 0;  // Fast exit if the map is empty. Required to prevent errors when printing an empty histogram
+    return 0;  // Fast exit if the histogram is empty. Required to prevent errors when printing an empty histogram
   }
   const auto& gConfig = pgis::config::GlobalConfig::get();
   const auto cuttoffMode = gConfig.getAs<pgis::options::CuttoffSelection>(pgis::options::cuttoffSelection.cliName).mode;
   switch (cuttoffMode) {
     case pgis::options::CuttoffSelection::CuttoffSelectionEnum::MAX:
-      return getHalfMaxFromHist(hist);
+      return hist.getHalfMax();
     case pgis::options::CuttoffSelection::CuttoffSelectionEnum::MEDIAN:
-      return getMedianFromHist(hist);
+      return hist.getMedian();
     case pgis::options::CuttoffSelection::CuttoffSelectionEnum::UNIQUE_MEDIAN:
-      return getUniqueMedianFromHist(hist);
+      return hist.getUniqueMedian();
     default:
       // Should never happen
       exit(-1);
   }
 }
-long int StatisticsEstimatorPhase::getUniqueMedianFromHist(const MapT& hist) const {
-  const auto toRandAccContainer = [&](const MapT& inCont) {
-    std::vector<MapT::key_type> keys;
-    for (const auto& n : inCont) {
-      keys.push_back(n.first);
-    }
-    return keys;
-  };
-
-  auto inclStmts = toRandAccContainer(hist);
-  std::nth_element(inclStmts.begin(), inclStmts.begin() + inclStmts.size() / 2, inclStmts.end());
-
-  const long int medianNumStmts = inclStmts[inclStmts.size() / 2];
-  return medianNumStmts;
-}
-
-long int StatisticsEstimatorPhase::getMedianFromHist(const MapT& hist) const {
-  const auto toRandAccContainer = [&](const MapT& inCont) {
-    std::vector<MapT::key_type> keys;
-    for (const auto& n : inCont) {
-      for (int i = 0; i < n.second; i++) {
-        keys.push_back(n.first);
-      }
-    }
-    return keys;
-  };
-  auto inclStmts = toRandAccContainer(hist);
-  std::nth_element(inclStmts.begin(), inclStmts.begin() + inclStmts.size() / 2, inclStmts.end());
-
-  const long int medianNumStmts = inclStmts[inclStmts.size() / 2];
-  return medianNumStmts;
-}
-
-long int StatisticsEstimatorPhase::getHalfMaxFromHist(const MapT& hist) const {
-  const auto toRandAccContainer = [&](const MapT& inCont) {
-    std::vector<MapT::key_type> keys;
-    for (const auto& n : inCont) {
-      for (int i = 0; i < n.second; i++) {
-        keys.push_back(n.first);
-      }
-    }
-    return keys;
-  };
-  auto inclStmts = toRandAccContainer(hist);
-  return (*std::max_element(inclStmts.begin(), inclStmts.end())) >> 1;
-}
 
 long int StatisticsEstimatorPhase::getCuttoffConditionalBranches() const {
   return getCuttoffValue(conditionalBranchesInclHist);
@@ -1282,6 +1215,7 @@ long int GlobalLoopDepthEstimatorPhase::getTargetCount(const CgNode* node) const
   }
 }
 void AttachInstrumentationResultsEstimatorPhase::modifyGraph(CgNode* mainMethod) {
+  metacg::analysis::GraphTraversal traversal(graph);
   for (const auto& elem : graph->getNodes()) {
     const auto& node = elem.get();
     // We have pretty exact information about a function if we instrument it and all of its childs
@@ -1317,21 +1251,12 @@ void AttachInstrumentationResultsEstimatorPhase::modifyGraph(CgNode* mainMethod)
         return !child->template getOrCreate<PiraOneData>().comesFromCube();
       });
       // Calculate the summing inclusive runtime
-      std::queue<CgNode*> workQueue;
-      workQueue.push(node);
-      std::set<CgNode*> visitedNodes;
       double inclusiveRuntimeSum = 0;
-      while (!workQueue.empty()) {
-        auto workNode = workQueue.front();
-        workQueue.pop();
-        if (visitedNodes.find(workNode) == visitedNodes.end()) {
-          visitedNodes.insert(workNode);
-          inclusiveRuntimeSum += workNode->get<BaseProfileData>()->getRuntimeInSeconds();
-          for (const auto childNode : graph->getCallees(*workNode)) {
-            workQueue.push(childNode);
-          }
-        }
-      }
+      traversal.bfs(node->getId(), metacg::analysis::TraversalDirection::Callees,
+                    metacg::analysis::GraphTraversal::Unbounded, [&](CgNode* workNode, unsigned) {
+                      inclusiveRuntimeSum += workNode->get<BaseProfileData>()->getRuntimeInSeconds();
+                      return metacg::analysis::VisitResult::Continue;
+                    });
 
       const auto md = &node->getOrCreate<InstrumentationResultMetaData>();
       if (!hasPrevExclusive) {
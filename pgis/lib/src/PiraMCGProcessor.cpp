@@ -106,12 +106,11 @@ int metacg::pgis::PiraMCGProcessor::getNumProcs() {
   int prevNum = 0;
   for (const auto& elem : graph->getNodes()) {
     const auto& node = elem.get();
-    if (!node->get<BaseProfileData>()->getCgLocation().empty()) {
-      for (const CgLocation& cgLoc : node->get<BaseProfileData>()->getCgLocation()) {
-        if (cgLoc.getProcId() != prevNum) {
-          prevNum = cgLoc.getProcId();
-          numProcs++;
-        }
+    const auto& cgLocs = node->get<BaseProfileData>()->getCgLocation();
+    for (std::uint32_t unit = 0; unit < cgLocs.getNumProcessingUnits(); ++unit) {
+      if (cgLocs.getUnitProcId(unit) != prevNum) {
+        prevNum = cgLocs.getUnitProcId(unit);
+        numProcs++;
       }
     }
     if (numProcs > 1) {
@@ -221,13 +220,13 @@ void metacg::pgis::PiraMCGProcessor::attachExtrapModels() {
   for (const auto& elem : graph->getNodes()) {
     const auto& n = elem.get();
     console->debug("Attaching models for {}", n->getFunctionName());
-    auto ptd = &n->getOrCreate<PiraTwoData>(epModelProvider.getModelFor(n->getFunctionName()));
+    auto ptd = &n->getOrCreate<PiraTwoData>(epModelProvider.getModelFor(*n));
     if (!ptd->getExtrapModelConnector().hasModels()) {
       console->trace("attachExtrapModels hasModels == false -> Setting new ModelConnector");
-      ptd->setExtrapModelConnector(epModelProvider.getModelFor(n->getFunctionName()));
+      ptd->setExtrapModelConnector(epModelProvider.getModelFor(*n));
     }
 
-    ptd->getExtrapModelConnector().setEpolator(extrapconnection::ExtrapExtrapolator(epModelProvider.getConfigValues()));
+    ptd->getExtrapModelConnector().setEpolator(epModelProvider.getExtrapolator());
 
     if (ptd->getExtrapModelConnector().hasModels()) {
       console->trace("attachExtrapModels for {} hasModels == true -> Use model aggregation strategy.",
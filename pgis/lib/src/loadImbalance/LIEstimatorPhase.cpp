@@ -21,7 +21,7 @@ using namespace metacg;
 using namespace LoadImbalance;
 
 LIEstimatorPhase::LIEstimatorPhase(std::unique_ptr<LIConfig>&& config, metacg::Callgraph* cg)
-    : EstimatorPhase("LIEstimatorPhase", cg) {
+    : EstimatorPhase("LIEstimatorPhase", cg), traversal(cg) {
   this->c = std::move(config);
 
   if (c->metricType == MetricType::Efficiency) {
@@ -144,44 +144,31 @@ void LIEstimatorPhase::modifyGraph(metacg::CgNode* mainMethod) {
 
 void LIEstimatorPhase::instrumentRelevantChildren(metacg::CgNode* node, pira::Statements statementThreshold,
                                                   std::ostringstream& debugString) {
-  std::queue<metacg::CgNode*> workQueue;
-  CgNodeRawPtrUSet visitedSet;
-  for (auto& child : graph->getCallees(*node)) {
-    workQueue.push(child);
-  }
-
-  while (!workQueue.empty()) {
-    metacg::CgNode* child = workQueue.front();
-    workQueue.pop();
-
-    // no double processing of child (or grandchilds)
-    if (visitedSet.find(child) != visitedSet.end()) {
-      // already processed
-      continue;
-    }
-    visitedSet.insert(child);
-
-    // process grandchilds (as possible implementations of virtual functions are children of those)
-    if (child->getOrCreate<LoadImbalance::LIMetaData>().isVirtual()) {
-      for (metacg::CgNode* gc : graph->getCallees(*child)) {
-        workQueue.push(gc);
-      }
-    }
-
-    if (child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements() >= statementThreshold) {
-      if (!child->getOrCreate<LIMetaData>().isFlagged(FlagType::Irrelevant)) {
-        instrument(child);
-        debugString << child->getFunctionName() << " ("
-                    << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements() << ") ";
-      } else {
-        debugString << "-" << child->getFunctionName() << "- ("
-                    << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements() << ") ";
-      }
-    } else {
-      debugString << "/" << child->getFunctionName() << "\\ ("
-                  << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements() << ") ";
-    }
-  }
+  const auto& children = graph->getCalleeIds(node->getId());
+  traversal.bfs(children.begin(), children.end(), analysis::TraversalDirection::Callees,
+                analysis::GraphTraversal::Unbounded, [&](metacg::CgNode* child, unsigned) {
+                  if (child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements() >=
+                      statementThreshold) {
+                    if (!child->getOrCreate<LIMetaData>().isFlagged(FlagType::Irrelevant)) {
+                      instrument(child);
+                      debugString << child->getFunctionName() << " ("
+                                  << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements()
+                                  << ") ";
+                    } else {
+                      debugString << "-" << child->getFunctionName() << "- ("
+                                  << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements()
+                                  << ") ";
+                    }
+                  } else {
+                    debugString << "/" << child->getFunctionName() << "\\ ("
+                                << child->getOrCreate<LoadImbalance::LIMetaData>().getNumberOfInclusiveStatements()
+                                << ") ";
+                  }
+
+                  // process grandchilds (as possible implementations of virtual functions are children of those)
+                  return child->getOrCreate<LoadImbalance::LIMetaData>().isVirtual() ? analysis::VisitResult::Continue
+                                                                                      : analysis::VisitResult::Prune;
+                });
 }
 
 void LoadImbalance::LIEstimatorPhase::contextHandling(metacg::CgNode* n, metacg::CgNode* mainNode,
@@ -229,40 +216,7 @@ void LoadImbalance::LIEstimatorPhase::contextHandling(metacg::CgNode* n, metacg:
 }
 
 bool LIEstimatorPhase::reachableInNSteps(metacg::CgNode* start, metacg::CgNode* end, int steps) {
-  struct Task {
-    CgNode* node;
-    int remainingSteps;
-  };
-
-  CgNodeRawPtrUSet visitedSet;
-  std::queue<Task> taskQueue;
-  taskQueue.push({start, steps});
-
-  while (!taskQueue.empty()) {
-    const Task currentTask = taskQueue.front();
-    taskQueue.pop();
-
-    // no double processing
-    if (visitedSet.find(currentTask.node) != visitedSet.end()) {
-      continue;
-    }
-    visitedSet.insert(currentTask.node);
-
-    // success
-    if (currentTask.node == end) {
-      return true;
-    }
-
-    // go deeper
-    if (currentTask.remainingSteps > 0) {
-      for (CgNode* child : graph->getCallees(*currentTask.node)) {
-        taskQueue.push({child, currentTask.remainingSteps - 1});
-      }
-    }
-  }
-
-  // failure
-  return false;
+  return traversal.existsPath(start->getId(), end->getId(), std::max(steps, 0));
 }
 
 void LIEstimatorPhase::instrument(CgNode* node) { pgis::instrumentNode(node); }
@@ -289,27 +243,17 @@ void LIEstimatorPhase::findSyncPoints(CgNode* node) {
 
 void LIEstimatorPhase::instrumentByPattern(CgNode* startNode, const std::function<bool(CgNode*)>& pattern,
                                            std::ostringstream& debugString) {
-  std::queue<CgNode*> workQueue;
-  CgNodeRawPtrUSet alreadyVisited;
-
-  workQueue.push(startNode);
-
-  while (!workQueue.empty()) {
-    CgNode* node = workQueue.front();
-    workQueue.pop();
-
-    // do not process a node twice
-    if (alreadyVisited.find(node) == alreadyVisited.end()) {
-      alreadyVisited.insert(node);
-      for (CgNode* child : graph->getCallees(*node)) {
-        workQueue.push(child);
-        if (pattern(child)) {
-          // mark for call-site instrumentation
-          // Fixme this is probably important, and should be moved to metadata
-          // child->instrumentFromParent(node);
-          debugString << " " << node->getFunctionName() << "->" << child->getFunctionName();
-        }
-      }
-    }
-  }
+  traversal.bfs(startNode->getId(), analysis::TraversalDirection::Callees, analysis::GraphTraversal::Unbounded,
+                [&](CgNode* node, unsigned) {
+                  for (const auto childId : graph->getCalleeIds(node->getId())) {
+                    CgNode* child = graph->getNode(childId);
+                    if (pattern(child)) {
+                      // mark for call-site instrumentation
+                      // Fixme this is probably important, and should be moved to metadata
+                      // child->instrumentFromParent(node);
+                      debugString << " " << node->getFunctionName() << "->" << child->getFunctionName();
+                    }
+                  }
+                  return analysis::VisitResult::Continue;
+                });
 }
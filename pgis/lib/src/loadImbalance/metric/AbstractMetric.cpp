@@ -7,85 +7,113 @@
 #include "loadImbalance/metric/AbstractMetric.h"
 #include "MetaData/CgNodeMetaData.h"
 
+#include "LoggerUtil.h"
+
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <limits>
-#include <map>
-#include <utility>
 
 LoadImbalance::AbstractMetric::AbstractMetric()
     : node(nullptr), max(.0), min(std::numeric_limits<double>::max()), mean(.0), stdev(.0), count(.0) {}
 
+namespace {
+// Number of independent accumulators. Breaks the loop-carried dependency of the reductions, so the compiler can keep
+// the lanes in SIMD registers without reassociating floating point operations.
+constexpr std::size_t NumLanes = 4;
+}  // namespace
+
 /**
- * Calculates the standard deviation of a non-empty vector
- * see
- *  - https://stackoverflow.com/a/7616783/3473012
+ * Single pass over the values, see
+ *  - https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Computing_shifted_data
+ * The squared deviations are accumulated relative to the first non-empty value, which avoids the cancellation of the
+ * naive sum-of-squares formula for series with a large mean and a small spread.
  */
-double calcStddev(std::vector<double>& v) {
-  assert(!v.empty() &&
-         "AbstractMetric.cpp: calcStddev: Can only calculate the standard deviation of a non-empty vector.");
+LoadImbalance::Indicators LoadImbalance::computeIndicators(const double* values, std::size_t numValues) {
+  Indicators ind;
+  ind.min = std::numeric_limits<double>::infinity();
 
-  double sum = std::accumulate(v.begin(), v.end(), 0.0);
-  double mean = sum / v.size();
+  const auto firstNonEmpty = std::find_if(values, values + numValues, [](double v) { return v > 0; });
+  if (firstNonEmpty == values + numValues) {
+    return ind;
+  }
+  const double shift = *firstNonEmpty;
+
+  double count[NumLanes] = {};
+  double sum[NumLanes] = {};
+  double shiftedSum[NumLanes] = {};
+  double shiftedSqSum[NumLanes] = {};
+  double max[NumLanes] = {};
+  double min[NumLanes];
+  std::fill(std::begin(min), std::end(min), std::numeric_limits<double>::infinity());
+
+  const auto accumulate = [&](std::size_t lane, double v) {
+    // branch-free masking of empty values
+    const double weight = v > 0 ? 1. : 0.;
+    const double shifted = (v - shift) * weight;
+    count[lane] += weight;
+    sum[lane] += v * weight;
+    shiftedSum[lane] += shifted;
+    shiftedSqSum[lane] += shifted * shifted;
+    max[lane] = v > max[lane] ? v : max[lane];
+    min[lane] = (v > 0 && v < min[lane]) ? v : min[lane];
+  };
+
+  const std::size_t numBlocked = numValues - numValues % NumLanes;
+  for (std::size_t i = 0; i < numBlocked; i += NumLanes) {
+    for (std::size_t lane = 0; lane < NumLanes; ++lane) {
+      accumulate(lane, values[i + lane]);
+    }
+  }
+  for (std::size_t i = numBlocked; i < numValues; ++i) {
+    accumulate(0, values[i]);
+  }
+
+  double totalCount = 0.;
+  double totalSum = 0.;
+  double totalShiftedSum = 0.;
+  double totalShiftedSqSum = 0.;
+  ind.max = 0.;
+  for (std::size_t lane = 0; lane < NumLanes; ++lane) {
+    totalCount += count[lane];
+    totalSum += sum[lane];
+    totalShiftedSum += shiftedSum[lane];
+    totalShiftedSqSum += shiftedSqSum[lane];
+    ind.max = std::max(ind.max, max[lane]);
+    ind.min = std::min(ind.min, min[lane]);
+  }
 
-  std::vector<double> diff(v.size());
-  std::transform(v.begin(), v.end(), diff.begin(), std::bind2nd(std::minus<double>(), mean));
-  double sqSum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-  double stdev = std::sqrt(sqSum / (v.size()));
+  ind.count = static_cast<int>(totalCount);
+  ind.mean = totalSum / totalCount;
+  if (ind.count > 1) {
+    const double variance = (totalShiftedSqSum - totalShiftedSum * totalShiftedSum / totalCount) / totalCount;
+    ind.stdev = std::sqrt(std::max(variance, 0.));
+  }
 
-  return stdev;
+  return ind;
 }
 
 void LoadImbalance::AbstractMetric::calcIndicators(std::ostringstream& debugString) {
-  const auto n = this->node;
-
-  // associate execution times to their processing unit (process, thread) and accumulate if necessary
-  std::map<std::pair<int, int>, double> timesTable;
-  if (!n->get<pira::BaseProfileData>()->getCgLocation().empty()) {  // profile information present
-    for (const auto loc : n->get<pira::BaseProfileData>()->getCgLocation()) {
-      const double localTime = loc.getInclusiveTime();
-
-      // skip empty locations
-      if (localTime > 0) {
-        auto procUnit = std::make_pair<int, int>(loc.getProcId(), loc.getThreadId());
-
-        // test whether processing unit is already known
-        if (timesTable.find(procUnit) != timesTable.end()) {
-          timesTable[procUnit] = timesTable[procUnit] + localTime;
-        } else {
-          timesTable[procUnit] = localTime;
-        }
+  // execution times are accumulated per processing unit (process, thread) while the profile is read
+  const auto& unitTimes = this->node->get<pira::BaseProfileData>()->getCgLocation().getInclusiveTimePerUnit();
+
+  // formatting one entry per processing unit is costly for large runs, only do it if it will be printed
+  if (metacg::MCGLogger::instance().getConsole()->should_log(spdlog::level::debug)) {
+    debugString << " [";
+    for (const double time : unitTimes) {
+      if (time > 0) {
+        debugString << time << " ";
       }
     }
+    debugString << "]";
   }
 
-  std::vector<double> times;
-  double sum = 0.;
-  this->count = 0;
-
-  debugString << " [";
-  for (auto kv : timesTable) {
-    // extract times from map
-    times.push_back(kv.second);
-    sum += kv.second;
-    this->count++;
-
-    debugString << kv.second << " ";
-  }
-  debugString << "]";
-
-  this->max = 0.;
-  this->min = INFINITY;
-  this->mean = 0;
-  this->stdev = 0;
-
-  if (count > 0) {
-    this->mean = sum / count;
-
-    this->stdev = count > 1 ? calcStddev(times) : 0.;
-
-    this->max = *std::max_element(times.begin(), times.end());
-    this->min = *std::min_element(times.begin(), times.end());
-  }
+  const auto ind = computeIndicators(unitTimes.data(), unitTimes.size());
+  this->max = ind.max;
+  this->min = ind.min;
+  this->mean = ind.mean;
+  this->stdev = ind.stdev;
+  this->count = ind.count;
 }
 
 void LoadImbalance::AbstractMetric::setNode(metacg::CgNode* newNode, std::ostringstream& debugString) {
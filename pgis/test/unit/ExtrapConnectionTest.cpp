@@ -0,0 +1,51 @@
+/**
+ * File: ExtrapConnectionTest.cpp
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "ExtrapConnection.h"
+#include "Utility.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace extrapconnection;
+
+TEST(ExtrapConnectionTest, ExtrapolationPointIsPrecomputed) {
+  ExtrapExtrapolator epolator({{".X", {2, 4, 8}}, {".Y", {10, 20}}});
+
+  const auto& point = epolator.getExtrapolationPoint();
+  ASSERT_EQ(point.size(), 2);
+  EXPECT_EQ(point[0].first, ".X");
+  // last value + average step
+  EXPECT_DOUBLE_EQ(point[0].second, 11.0);
+  EXPECT_EQ(point[1].first, ".Y");
+  EXPECT_DOUBLE_EQ(point[1].second, 30.0);
+
+  // default step width yields the precomputed point, other widths are computed on request
+  EXPECT_EQ(epolator.getExtrapolationValue(), point);
+  EXPECT_DOUBLE_EQ(epolator.getExtrapolationValue(2.0)[0].second, 14.0);
+
+  // copies share the precomputed point
+  const auto copy = epolator;
+  EXPECT_EQ(&copy.getExtrapolationPoint(), &point);
+}
+
+TEST(ExtrapConnectionTest, EmptyConfigHasEmptyExtrapolationPoint) {
+  ExtrapExtrapolator epolator({});
+  EXPECT_TRUE(epolator.getExtrapolationPoint().empty());
+}
+
+TEST(ExtrapConnectionTest, ParallelForVisitsEachIndexOnce) {
+  constexpr std::size_t numItems = 10007;
+  std::vector<std::atomic<int>> visits(numItems);
+  utils::parallelFor(numItems, [&](std::size_t i) { visits[i]++; });
+  for (const auto& v : visits) {
+    ASSERT_EQ(v.load(), 1);
+  }
+
+  bool called = false;
+  utils::parallelFor(0, [&](std::size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
@@ -0,0 +1,90 @@
+/**
+ * File: HistogramTest.cpp
+ * License: Part of the metacg project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "Histogram.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace metacg::pgis;
+
+TEST(HistogramTest, EmptyHistogramYieldsZero) {
+  Histogram hist;
+  EXPECT_TRUE(hist.empty());
+  EXPECT_EQ(hist.getMedian(), 0);
+  EXPECT_EQ(hist.getUniqueMedian(), 0);
+  EXPECT_EQ(hist.getHalfMax(), 0);
+  EXPECT_EQ(hist.getPercentile(.9), 0);
+}
+
+TEST(HistogramTest, QueriesMatchExpandedSamples) {
+  Histogram hist;
+  std::vector<long int> samples;
+  const std::vector<std::pair<long int, long int>> input{{3, 5}, {1, 2}, {42, 1}, {7, 4}, {0, 3}};
+  for (const auto& [value, count] : input) {
+    hist.add(value, count);
+    samples.insert(samples.end(), count, value);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  ASSERT_EQ(hist.getTotalCount(), samples.size());
+  EXPECT_EQ(hist.getNumBuckets(), input.size());
+  EXPECT_EQ(hist.getMedian(), samples[samples.size() / 2]);
+  EXPECT_EQ(hist.getHalfMax(), 21);
+  EXPECT_EQ(hist.getMin(), 0);
+  // distinct values: 0 1 3 7 42
+  EXPECT_EQ(hist.getUniqueMedian(), 3);
+  for (double p : {.0, .1, .25, .5, .75, .9, 1.0}) {
+    const auto rank = std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()));
+    EXPECT_EQ(hist.getPercentile(p), samples[rank]) << "p = " << p;
+  }
+}
+
+TEST(HistogramTest, MergeAddsBucketCounts) {
+  Histogram lhs;
+  lhs.add(1, 2);
+  lhs.add(5);
+  Histogram rhs;
+  rhs.add(5, 3);
+  rhs.add(9);
+  lhs.merge(rhs);
+  EXPECT_EQ(lhs.getTotalCount(), 7);
+  EXPECT_EQ(lhs.getNumBuckets(), 3);
+  EXPECT_EQ(lhs.getMedian(), 5);
+  EXPECT_EQ(lhs.getMax(), 9);
+}
+
+TEST(HistogramTest, SketchStaysWithinRelativeAccuracy) {
+  const double accuracy = .01;
+  QuantileSketch lhs(accuracy);
+  QuantileSketch rhs(accuracy);
+  std::vector<double> samples;
+  for (int i = 1; i <= 10000; ++i) {
+    samples.push_back(i);
+    (i % 2 ? lhs : rhs).add(i);
+  }
+  lhs.merge(rhs);
+  ASSERT_EQ(lhs.getCount(), samples.size());
+  EXPECT_LT(lhs.getNumBuckets(), samples.size() / 10);
+  for (double q : {.1, .5, .99}) {
+    const auto exact = samples[static_cast<std::size_t>(q * samples.size())];
+    EXPECT_LE(std::abs(lhs.getQuantile(q) - exact), accuracy * exact) << "q = " << q;
+  }
+}
+
+TEST(HistogramTest, SketchFromHistogram) {
+  Histogram hist;
+  hist.add(-4, 2);
+  hist.add(0, 1);
+  hist.add(100, 2);
+  const auto sketch = hist.toSketch();
+  EXPECT_EQ(sketch.getCount(), 5);
+  EXPECT_NEAR(sketch.getQuantile(.0), -4, .04);
+  EXPECT_DOUBLE_EQ(sketch.getQuantile(.5), .0);
+  EXPECT_NEAR(sketch.getQuantile(1.0), 100, 1);
+}
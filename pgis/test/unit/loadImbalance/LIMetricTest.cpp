@@ -11,6 +11,10 @@
 #include <loadImbalance/metric/ImbalancePercentageMetric.h>
 #include <loadImbalance/metric/VariationCoeffMetric.h>
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 using namespace metacg;
 
 TEST(LIMetricTest, EfficiencyMetric) {
@@ -213,3 +217,57 @@ TEST(LIMetricTest, ImbalancePercentageMetric) {
     ASSERT_EQ(metric.calc(), 0.0);
   }
 }
+
+TEST(LIMetricTest, LocationsAccumulatePerProcessingUnit) {
+  LoadImbalance::EfficiencyMetric metric;
+
+  auto cg = std::make_unique<Callgraph>();
+
+  auto func = &cg->insert("func");
+  auto main = &cg->insert("main");
+
+  func->getOrCreate<pira::BaseProfileData>();
+  // two samples on (proc 1, thread 1) are accumulated, the empty sample does not create a non-empty unit
+  func->get<pira::BaseProfileData>()->setCallData(main, 1, 2.0, 2.0, 1, 1);
+  func->get<pira::BaseProfileData>()->setCallData(main, 1, 2.0, 2.0, 1, 1);
+  func->get<pira::BaseProfileData>()->setCallData(main, 1, 2.0, 2.0, 1, 2);
+  func->get<pira::BaseProfileData>()->setCallData(main, 1, 0.0, 0.0, 2, 2);
+
+  const auto& locs = func->get<pira::BaseProfileData>()->getCgLocation();
+  ASSERT_EQ(locs.size(), 4);
+  ASSERT_EQ(locs.getNumProcessingUnits(), 3);
+  ASSERT_EQ(locs.getProcId(3), 2);
+  ASSERT_EQ(locs.getThreadId(3), 2);
+  ASSERT_EQ(locs.getInclusiveTimePerUnit().at(0), 4.0);
+
+  metric.setNode(func);
+  // max 4.0, mean 3.0 over the two non-empty units
+  EXPECT_NEAR(metric.calc(), 4.0 / 3.0, 1e-12);
+}
+
+TEST(LIMetricTest, ComputeIndicatorsMatchesTwoPass) {
+  std::vector<double> values;
+  for (int i = 0; i < 1027; ++i) {
+    // a large offset with small spread, interleaved with empty entries
+    values.push_back(i % 7 == 0 ? 0.0 : 1e6 + (i % 13) * 0.25);
+  }
+
+  std::vector<double> nonEmpty;
+  std::copy_if(values.begin(), values.end(), std::back_inserter(nonEmpty), [](double v) { return v > 0; });
+  const double mean = std::accumulate(nonEmpty.begin(), nonEmpty.end(), 0.0) / nonEmpty.size();
+  double sqSum = 0.;
+  for (const double v : nonEmpty) {
+    sqSum += (v - mean) * (v - mean);
+  }
+
+  const auto ind = LoadImbalance::computeIndicators(values.data(), values.size());
+  ASSERT_EQ(ind.count, static_cast<int>(nonEmpty.size()));
+  EXPECT_NEAR(ind.mean, mean, 1e-6);
+  EXPECT_NEAR(ind.stdev, std::sqrt(sqSum / nonEmpty.size()), 1e-6);
+  EXPECT_EQ(ind.max, *std::max_element(nonEmpty.begin(), nonEmpty.end()));
+  EXPECT_EQ(ind.min, *std::min_element(nonEmpty.begin(), nonEmpty.end()));
+
+  const auto empty = LoadImbalance::computeIndicators(values.data(), 0);
+  EXPECT_EQ(empty.count, 0);
+  EXPECT_EQ(empty.mean, 0.0);
+}
@@ -0,0 +1,216 @@
+/**
+ * File: EdgeLog.h
+ * License: Part of the MetaCG project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#ifndef META_CG_CG_PATCH_EDGELOG_H
+#define META_CG_CG_PATCH_EDGELOG_H
+
+#include "Callgraph.h"
+#include "metadata/RuntimeCallCountMD.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cgpatch {
+
+/**
+ * Calls of an edge and the time of the first one, in nanoseconds since the start of the observing process
+ */
+struct CallCount {
+  uint64_t count = 0;
+  uint64_t firstSeen = 0;
+
+  void add(uint64_t moreCalls, uint64_t seen) {
+    if (moreCalls != 0) {
+      firstSeen = count == 0 ? seen : std::min(firstSeen, seen);
+      count += moreCalls;
+    }
+  }
+};
+
+/**
+ * Deduplicated call graph edges with a string table shared by all edges, the format in which the runtime exchanges
+ * and logs call graphs. Serialized as the number of names and edges (32-bit), the NUL-terminated names and the edges
+ * as pairs of name indices (32-bit) followed by their call count and first observation (64-bit), all in host byte
+ * order.
+ */
+class EdgeList {
+ public:
+  EdgeList() = default;
+  // The string table refers to the keys of the name index
+  EdgeList(const EdgeList&) = delete;
+  EdgeList& operator=(const EdgeList&) = delete;
+  EdgeList(EdgeList&&) = default;
+  EdgeList& operator=(EdgeList&&) = default;
+
+  static EdgeList fromCallgraph(const metacg::Callgraph& callgraph) {
+    EdgeList list;
+    for (const auto& [edge, metadata] : callgraph.getEdges()) {
+      CallCount callCount;
+      if (const auto mdIt = metadata.find(metacg::RuntimeCallCountMD::key); mdIt != metadata.end()) {
+        const auto* md = static_cast<const metacg::RuntimeCallCountMD*>(mdIt->second.get());
+        callCount = {md->getCount(), md->getFirstSeen()};
+      }
+      list.addEdge(list.addName(callgraph.getNode(edge.first)->getFunctionName()),
+                   list.addName(callgraph.getNode(edge.second)->getFunctionName()), callCount);
+    }
+    return list;
+  }
+
+  /**
+   * Adds the edges of a serialized list, the names of both lists are unified
+   * @return false if the buffer is malformed, the edges read up to the error are kept
+   */
+  bool merge(const char* data, std::size_t size) {
+    const char* const end = data + size;
+    uint32_t numNames, numEdges;
+    if (!read(data, end, numNames) || !read(data, end, numEdges)) {
+      return false;
+    }
+    std::vector<uint32_t> ids;
+    ids.reserve(numNames);
+    for (uint32_t i = 0; i < numNames; ++i) {
+      const auto* nameEnd = static_cast<const char*>(std::memchr(data, '\0', end - data));
+      if (!nameEnd) {
+        return false;
+      }
+      ids.push_back(addName(std::string(data, nameEnd)));
+      data = nameEnd + 1;
+    }
+    for (uint32_t i = 0; i < numEdges; ++i) {
+      uint32_t caller, callee;
+      CallCount callCount;
+      if (!read(data, end, caller) || !read(data, end, callee) || !read(data, end, callCount.count) ||
+          !read(data, end, callCount.firstSeen) || caller >= numNames || callee >= numNames) {
+        return false;
+      }
+      addEdge(ids[caller], ids[callee], callCount);
+    }
+    return true;
+  }
+
+  void addEdge(const std::string& caller, const std::string& callee, const CallCount& callCount) {
+    addEdge(addName(caller), addName(callee), callCount);
+  }
+
+  bool empty() const { return edges.empty(); }
+
+  bool hasCallCounts() const {
+    return std::any_of(edges.begin(), edges.end(), [](const auto& edge) { return edge.second.count != 0; });
+  }
+
+  std::vector<char> serialize() const {
+    std::vector<char> buffer;
+    write(buffer, static_cast<uint32_t>(names.size()));
+    write(buffer, static_cast<uint32_t>(edges.size()));
+    for (const auto* name : names) {
+      buffer.insert(buffer.end(), name->c_str(), name->c_str() + name->size() + 1);
+    }
+    for (const auto& [edge, callCount] : edges) {
+      write(buffer, static_cast<uint32_t>(edge >> 32));
+      write(buffer, static_cast<uint32_t>(edge));
+      write(buffer, callCount.count);
+      write(buffer, callCount.firstSeen);
+    }
+    return buffer;
+  }
+
+  /**
+   * Adds the edges that are missing in the call graph. The call counts replace those of the call graph, so the list
+   * must include the edges of the call graph.
+   */
+  void addToCallgraph(metacg::Callgraph& callgraph) const {
+    for (const auto& [edge, callCount] : edges) {
+      metacg::CgNode& caller = callgraph.getOrInsertNode(*names[edge >> 32]);
+      metacg::CgNode& callee = callgraph.getOrInsertNode(*names[static_cast<uint32_t>(edge)]);
+      if (!callgraph.existsEdge(caller.getId(), callee.getId())) {
+        // set hasBody to true so the call-graphs can be fully merged
+        caller.setHasBody(true);
+        callee.setHasBody(true);
+        callgraph.addEdge(caller, callee);
+      }
+      if (callCount.count != 0) {
+        callgraph.addEdgeMetaData({caller.getId(), callee.getId()},
+                                  std::make_unique<metacg::RuntimeCallCountMD>(callCount.count, callCount.firstSeen));
+      }
+    }
+  }
+
+ private:
+  uint32_t addName(std::string name) {
+    auto [it, inserted] = nameIds.try_emplace(std::move(name), static_cast<uint32_t>(names.size()));
+    if (inserted) {
+      names.push_back(&it->first);
+    }
+    return it->second;
+  }
+
+  void addEdge(uint32_t caller, uint32_t callee, const CallCount& callCount) {
+    edges[static_cast<uint64_t>(caller) << 32 | callee].add(callCount.count, callCount.firstSeen);
+  }
+
+  template <typename T>
+  static bool read(const char*& data, const char* end, T& value) {
+    if (end - data < static_cast<std::ptrdiff_t>(sizeof(value))) {
+      return false;
+    }
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+  }
+
+  template <typename T>
+  static void write(std::vector<char>& buffer, T value) {
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+  }
+
+  std::unordered_map<std::string, uint32_t> nameIds;
+  std::vector<const std::string*> names;          // Keys of nameIds, by index
+  std::unordered_map<uint64_t, CallCount> edges;  // Caller index in the upper, callee index in the lower half
+};
+
+/**
+ * The edge log is a sequence of blocks, each holding the edges added since the previous one. A block is the magic
+ * number, the size of the serialized edge list (32-bit each) and the edge list. A block cut off by an abnormal
+ * termination is detected by its size.
+ */
+constexpr uint32_t EdgeLogBlockMagic = 0x4c47434d;  // "MCGL"
+
+inline std::vector<char> createEdgeLogBlock(const EdgeList& edges) {
+  const auto serialized = edges.serialize();
+  const uint32_t header[] = {EdgeLogBlockMagic, static_cast<uint32_t>(serialized.size())};
+  std::vector<char> block(reinterpret_cast<const char*>(header), reinterpret_cast<const char*>(header + 2));
+  block.insert(block.end(), serialized.begin(), serialized.end());
+  return block;
+}
+
+/**
+ * Adds the edges of all complete blocks of a log
+ * @return The number of bytes of the log that belong to complete blocks
+ */
+inline std::size_t readEdgeLog(const char* data, std::size_t size, EdgeList& edges) {
+  std::size_t offset = 0;
+  while (size - offset >= 2 * sizeof(uint32_t)) {
+    uint32_t header[2];
+    std::memcpy(header, data + offset, sizeof(header));
+    if (header[0] != EdgeLogBlockMagic || size - offset - sizeof(header) < header[1]) {
+      break;
+    }
+    if (!edges.merge(data + offset + sizeof(header), header[1])) {
+      break;
+    }
+    offset += sizeof(header) + header[1];
+  }
+  return offset;
+}
+
+}  // namespace cgpatch
+
+#endif  // META_CG_CG_PATCH_EDGELOG_H
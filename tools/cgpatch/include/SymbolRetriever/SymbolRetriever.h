@@ -12,6 +12,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -30,8 +31,46 @@ struct MemMapEntry {
   uint64_t offset;
 };
 
+/**
+ * Address ranges of the symbols of an object file, sorted by their start. Names are stored in a single blob.
+ * Aliases are merged into one entry named after the lexicographically greatest alias.
+ */
+class SymbolIndex {
+ public:
+  void add(uint64_t start, uint64_t size, std::string_view name);
+
+  /**
+   * Sorts the entries and merges aliases, needs to be called after all symbols are added
+   */
+  void finalize();
+
+  /**
+   * @return The symbol that contains the address, empty if there is none. Symbols without a size only match their
+   * start address.
+   */
+  std::string_view find(uint64_t addr) const;
+
+  std::size_t size() const { return starts.size(); }
+
+  bool empty() const { return starts.empty(); }
+
+ private:
+  struct Entry {
+    uint64_t size;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    // The symbol whose range contains the start of this one, itself if there is none
+    uint32_t enclosing;
+  };
+
+  // Separate from the entries, so the search only touches the start addresses
+  std::vector<uint64_t> starts;
+  std::vector<Entry> entries;
+  std::string names;
+};
+
 struct MappedSymTable {
-  SymbolTable table;
+  SymbolIndex symbols;
   MemMapEntry memMap;
 };
 
@@ -43,7 +82,20 @@ using MappedSymTableMap = std::map<uintptr_t, MappedSymTable>;
  */
 MappedSymTableMap loadMappedSymTables(const std::string& execFile, bool printDebug = false);
 
+/**
+ * Brings the symbol tables up to date with the objects currently loaded into the process. Only objects that were
+ * loaded since the last update are read, the tables of unloaded objects are removed.
+ * @return The number of added objects
+ */
+std::size_t updateMappedSymTables(MappedSymTableMap& mappedSymTables);
+
 SymbolTable loadSymbolTable(const std::string& objectFile);
+
+/**
+ * Loads the symbols of an object file with their sizes. On x86-64, the PLT entries are named after the function they
+ * jump to, as the address of an external function is its PLT entry in non-PIE executables.
+ */
+SymbolIndex loadSymbolIndex(const std::string& objectFile);
 /**
  * Loads symbols from the executable and all shared library dependencies.
  * @param execFile
@@ -0,0 +1,75 @@
+/**
+ * File: CGPatchCompact.cpp
+ * License: Part of the MetaCG project. Licensed under BSD 3 clause license. See LICENSE.txt file at
+ * https://github.com/tudasc/metacg/LICENSE.txt
+ */
+
+#include "config.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "EdgeLog.h"
+#include "LoggerUtil.h"
+#include "MCGManager.h"
+#include "io/VersionFourMCGWriter.h"
+#include "io/VersionTwoMCGWriter.h"
+
+// This may appear to be unused, but the variables declared here have side effects on the graph lib
+#include "metadata/BuiltinMD.h"
+
+using namespace metacg;
+
+/**
+ * Compacts the edge logs written by the cgpatch runtime into a single call graph. The logs of processes that terminated
+ * abnormally end with an incomplete block, which is ignored.
+ */
+int main(int argc, char** argv) {
+  auto console = MCGLogger::instance().getConsole();
+  auto errConsole = MCGLogger::instance().getErrConsole();
+
+  console->info("Running metacg::CGPatchCompact (version {}.{})\nGit revision: {}", MetaCG_VERSION_MAJOR,
+                MetaCG_VERSION_MINOR, MetaCG_GIT_SHA);
+
+  if (argc < 3) {
+    errConsole->error("Invalid input arguments. Usage: cgpatch-compact <outfile> <edgelog1> <edgelog2> ...");
+    return EXIT_FAILURE;
+  }
+
+  const char* outfile = argv[1];
+
+  cgpatch::EdgeList edges;
+  for (int i = 2; i < argc; ++i) {
+    std::ifstream is(argv[i], std::ios::binary);
+    if (!is.is_open()) {
+      errConsole->error("Unable to open edge log {}", argv[i]);
+      return EXIT_FAILURE;
+    }
+    const std::vector<char> log{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+    if (const auto read = cgpatch::readEdgeLog(log.data(), log.size(), edges); read != log.size()) {
+      errConsole->warn("Ignoring the last {} bytes of edge log {}, the log is incomplete", log.size() - read, argv[i]);
+    }
+  }
+
+  auto& mcgManager = graph::MCGManager::get();
+  mcgManager.resetManager();
+  auto* callgraph = mcgManager.getOrCreateCallgraph("compactedCallGraph", true);
+  edges.addToCallgraph(*callgraph);
+
+  io::JsonSink jsonSink;
+  if (edges.hasCallCounts()) {
+    // Edge metadata requires format version 4
+    io::VersionFourMCGWriter mcgWriter;
+    mcgWriter.setUseNamesAsIds(true);
+    mcgWriter.write(callgraph, jsonSink);
+  } else {
+    io::VersionTwoMCGWriter mcgWriter;
+    mcgWriter.write(callgraph, jsonSink);
+  }
+
+  std::ofstream os(outfile);
+  os << jsonSink.getJson() << std::endl;
+
+  console->info("Compacted {} edge logs", argc - 2);
+  return EXIT_SUCCESS;
+}
@@ -5,16 +5,22 @@
  */
 
 #include "nlohmann/json.hpp"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Demangle/Demangle.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 #include <fstream>
 #include <iostream>
 #include <llvm/ADT/StringRef.h>
@@ -30,11 +36,136 @@ using namespace cgpatch;
 static cl::opt<bool> instrumentCtorsDtors("instrument-ctors-dtors", cl::desc("Instrument constructors and destructors"),
                                           cl::init(false));
 
+static cl::opt<bool> instrumentVirtualCalls("instrument-virtual-calls",
+                                            cl::desc("Instrument virtual calls to record their dynamic targets"),
+                                            cl::init(false));
+
 static cl::opt<bool> verbose("cgpatch-verbose", cl::desc("Print debugging output"), cl::init(false));
 
 namespace {
 
-void insertMetaCGCall(Instruction& ins, Function& f, Value* calledOperand, Function* runtimeFunction);
+// Targets cached inline per call site, must match the runtime
+constexpr unsigned CallSiteCacheEntries = 2;
+
+/**
+ * Descriptors of the instrumented call sites of a module. The table is emitted into the metacg_callsites section and
+ * registered with the runtime by a module constructor. Instrumented calls pass the ID of their call site, which is the
+ * index into the table plus the first ID the runtime assigns to the module.
+ * Layout of an entry: {const char* caller, const char* file, uint32_t ordinal, uint32_t line, uint32_t column}
+ * Every call site also gets a row of CallSiteCacheEntries targets in the zero-initialized __metacg_callsite_cache,
+ * which the runtime fills with the targets it has recorded.
+ */
+class CallSiteTable {
+ public:
+  explicit CallSiteTable(Module& M)
+      : M(M),
+        int32Ty(Type::getInt32Ty(M.getContext())),
+        ptrTy(PointerType::get(M.getContext(), 0)),
+        descriptorType(StructType::get(M.getContext(), {ptrTy, ptrTy, int32Ty, int32Ty, int32Ty})) {
+    baseId = new GlobalVariable(M, int32Ty, false, GlobalValue::InternalLinkage, ConstantInt::get(int32Ty, 0),
+                                "__metacg_callsite_base");
+    // The number of call sites is only known at the end, the placeholder is replaced by the cache then
+    cache = new GlobalVariable(M, ArrayType::get(ptrTy, 0), false, GlobalValue::ExternalLinkage, nullptr,
+                               "__metacg_callsite_cache.placeholder");
+  }
+
+  /**
+   * Adds a descriptor for the call site
+   * @return The index of the call site in the table
+   */
+  unsigned addCallSite(Instruction& ins, Function& caller) {
+    Constant* file = ConstantPointerNull::get(ptrTy);
+    unsigned line = 0;
+    unsigned column = 0;
+    if (const auto& loc = ins.getDebugLoc()) {
+      file = getString(loc->getFilename());
+      line = loc.getLine();
+      column = loc.getCol();
+    }
+    auto& callerName = callerNames[&caller];
+    if (!callerName) {
+      callerName = getString(caller.getName());
+    }
+    descriptors.push_back(ConstantStruct::get(
+        descriptorType, {callerName, file, ConstantInt::get(int32Ty, ordinals[&caller]++),
+                         ConstantInt::get(int32Ty, line), ConstantInt::get(int32Ty, column)}));
+    return static_cast<unsigned>(descriptors.size() - 1);
+  }
+
+  Value* createCallSiteId(IRBuilder<>& builder, unsigned index) {
+    auto* base = builder.CreateLoad(int32Ty, baseId);
+    return builder.CreateAdd(base, ConstantInt::get(int32Ty, index));
+  }
+
+  /**
+   * @return The address of the cached targets of the call site
+   */
+  Value* createCacheEntries(IRBuilder<>& builder, unsigned index) {
+    return builder.CreateConstInBoundsGEP1_32(ArrayType::get(ptrTy, CallSiteCacheEntries), cache, index);
+  }
+
+  /**
+   * Emits the table and the constructor that registers it, if any call site was instrumented
+   */
+  void emit() {
+    if (descriptors.empty()) {
+      baseId->eraseFromParent();
+      cache->eraseFromParent();
+      return;
+    }
+    auto* tableType = ArrayType::get(descriptorType, descriptors.size());
+    auto* table = new GlobalVariable(M, tableType, true, GlobalValue::PrivateLinkage,
+                                     ConstantArray::get(tableType, descriptors), "__metacg_callsites");
+    table->setSection("metacg_callsites");
+    table->setAlignment(Align(8));
+
+    // Rows do not straddle cache lines
+    auto* cacheType = ArrayType::get(ArrayType::get(ptrTy, CallSiteCacheEntries), descriptors.size());
+    auto* cacheVar = new GlobalVariable(M, cacheType, false, GlobalValue::InternalLinkage,
+                                        ConstantAggregateZero::get(cacheType), "__metacg_callsite_cache");
+    cacheVar->setAlignment(Align(8 * CallSiteCacheEntries));
+    cache->replaceAllUsesWith(cacheVar);
+    cache->eraseFromParent();
+
+    auto& Context = M.getContext();
+    auto registerType = FunctionType::get(Type::getVoidTy(Context), {ptrTy, int32Ty, ptrTy, ptrTy}, false);
+    auto registerFunction = M.getOrInsertFunction("__metacg_register_call_sites", registerType);
+    auto* ctor = Function::Create(FunctionType::get(Type::getVoidTy(Context), false), GlobalValue::InternalLinkage,
+                                  "__metacg_register_module_call_sites", M);
+    IRBuilder<> builder(BasicBlock::Create(Context, "entry", ctor));
+    builder.CreateCall(registerFunction, {table, ConstantInt::get(int32Ty, descriptors.size()), baseId, cacheVar});
+    builder.CreateRetVoid();
+    // Before all other constructors, which may already perform instrumented calls
+    appendToGlobalCtors(M, ctor, 0);
+  }
+
+ private:
+  Constant* getString(StringRef str) {
+    auto& global = strings[str];
+    if (!global) {
+      auto* init = ConstantDataArray::getString(M.getContext(), str);
+      auto* var = new GlobalVariable(M, init->getType(), true, GlobalValue::PrivateLinkage, init, ".str.metacg");
+      var->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+      var->setAlignment(Align(1));
+      global = var;
+    }
+    return global;
+  }
+
+  Module& M;
+  IntegerType* int32Ty;
+  PointerType* ptrTy;
+  StructType* descriptorType;
+  GlobalVariable* baseId;
+  GlobalVariable* cache;
+  std::vector<Constant*> descriptors;
+  DenseMap<Function*, Constant*> callerNames;
+  DenseMap<Function*, unsigned> ordinals;
+  StringMap<Constant*> strings;
+};
+
+void insertMetaCGCall(Instruction& ins, Function& f, Value* calledOperand, Function* runtimeFunction,
+                      CallSiteTable& callSites);
 
 // Instrumentation
 void instrumentIndirectCalls(Module& M) {
@@ -43,11 +174,18 @@ void instrumentIndirectCalls(Module& M) {
   // Counter variables
   int indirectCallCount{0};
   int ctorDtorCallCount{0};
+  int virtualCallCount{0};
   // Create function declaration
   LLVMContext& Context = M.getContext();
-  auto functionType =
-      FunctionType::get(Type::getVoidTy(Context), {PointerType::get(Context, 0), PointerType::get(Context, 0)}, false);
-  Function* runtimeFunction = cast<Function>(M.getOrInsertFunction("__metacg_indirect_call", functionType).getCallee());
+  auto* ptrTy = PointerType::get(Context, 0);
+  auto functionType = FunctionType::get(Type::getVoidTy(Context), {Type::getInt32Ty(Context), ptrTy, ptrTy}, false);
+  // Named after its signature, so objects instrumented for another runtime ABI fail to link instead of passing
+  // arguments the runtime misinterprets
+  Function* runtimeFunction =
+      cast<Function>(M.getOrInsertFunction("__metacg_indirect_call_site", functionType).getCallee());
+  CallSiteTable callSites(M);
+  // Instrumentation splits the blocks, so the calls are collected first
+  std::vector<std::pair<CallBase*, Function*>> toInstrument;
 
   for (Function& F : M) {
     if (verbose) {
@@ -72,41 +210,67 @@ void instrumentIndirectCalls(Module& M) {
             // Setup demangler's internal state to work on the called function name
             demangler.partialDemangle(calledFunction->getName().str().c_str());
             if (demangler.isCtorOrDtor()) {  // constructor call
-              insertMetaCGCall(Ins, F, CB->getCalledOperand(), runtimeFunction);
+              toInstrument.emplace_back(CB, &F);
               ctorDtorCallCount++;
             }
           }
+        } else if (CT == CallType::Virtual) {
+          // Hot virtual calls mostly hit the inline target cache of their call site
+          if (instrumentVirtualCalls) {
+            toInstrument.emplace_back(CB, &F);
+            virtualCallCount++;
+          }
         } else {  // indirect call
-          if (CT == CallType::Virtual)
-            continue;
-
-          insertMetaCGCall(Ins, F, CB->getCalledOperand(), runtimeFunction);
+          toInstrument.emplace_back(CB, &F);
           indirectCallCount++;
         }
       }
   }
+  for (auto [CB, F] : toInstrument) {
+    insertMetaCGCall(*CB, *F, CB->getCalledOperand(), runtimeFunction, callSites);
+  }
+  callSites.emit();
   if (verbose) {
-    llvm::outs() << "[Info] Instrumented " << (indirectCallCount + ctorDtorCallCount) << " function calls in "
-                 << M.getName().str() << ":\n"
+    llvm::outs() << "[Info] Instrumented " << (indirectCallCount + virtualCallCount + ctorDtorCallCount)
+                 << " function calls in " << M.getName().str() << ":\n"
                  << "\t" << indirectCallCount << ": "
                  << "Indirect functions.\n"
+                 << "\t" << virtualCallCount << ": "
+                 << "Virtual functions.\n"
                  << "\t" << ctorDtorCallCount << ": "
                  << "constructors and destructors."
                  << "\n";
   }
 }
 
-// Insert call to __metacg_indirect_call before the current instruction
-void insertMetaCGCall(Instruction& ins, Function& f, Value* calledOperand, Function* runtimeFunction) {
+// Insert call to __metacg_indirect_call_site before the current instruction, which is skipped if the target is cached
+void insertMetaCGCall(Instruction& ins, Function& f, Value* calledOperand, Function* runtimeFunction,
+                      CallSiteTable& callSites) {
   IRBuilder<> Builder(&ins);
-  auto* strArg = Builder.CreateGlobalString(f.getName().str());
-  Builder.CreateCall(runtimeFunction, {strArg, calledOperand});
+  const auto index = callSites.addCallSite(ins, f);
+  auto* cacheEntries = callSites.createCacheEntries(Builder, index);
+  auto* ptrTy = PointerType::get(ins.getContext(), 0);
+  Value* isCached = nullptr;
+  for (unsigned i = 0; i < CallSiteCacheEntries; ++i) {
+    // Unordered, as the runtime fills the cache concurrently
+    auto* entry = Builder.CreateConstInBoundsGEP1_32(ptrTy, cacheEntries, i);
+    auto* cached = Builder.CreateAlignedLoad(ptrTy, entry, Align(8));
+    cached->setAtomic(AtomicOrdering::Unordered);
+    auto* isEqual = Builder.CreateICmpEQ(cached, calledOperand);
+    isCached = isCached ? Builder.CreateOr(isCached, isEqual) : isEqual;
+  }
+
+  auto* missTerm = SplitBlockAndInsertIfThen(Builder.CreateNot(isCached), &ins, false,
+                                             MDBuilder(ins.getContext()).createBranchWeights(1, 1000));
+  Builder.SetInsertPoint(missTerm);
+  Builder.CreateCall(runtimeFunction, {callSites.createCallSiteId(Builder, index), calledOperand, cacheEntries});
 }
 
 struct CGPatchInst : PassInfoMixin<CGPatchInst> {
   PreservedAnalyses run(Module& M, ModuleAnalysisManager&) {
     instrumentIndirectCalls(M);
-    return PreservedAnalyses::all();
+    // Blocks are split at the cached call sites, so the CFG analyses are invalidated as well
+    return PreservedAnalyses::none();
   }
   // We also need to be able to instrument optnone annotated functions
   static bool isRequired() { return true; }
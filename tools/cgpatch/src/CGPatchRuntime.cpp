@@ -5,23 +5,42 @@
  */
 
 #include "Callgraph.h"
-#include "MergePolicy.h"
+#include "EdgeLog.h"
+#include "MCGManager.h"
 #include "SymbolRetriever.h"
-#include "io/VersionTwoMCGReader.h"
+#include "io/VersionFourMCGWriter.h"
 #include "io/VersionTwoMCGWriter.h"
+#include "metadata/RuntimeCallCountMD.h"
 #include "nlohmann/json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
 #include <filesystem>
+#include <link.h>
+#include <optional>
+#include <thread>
+#include <unistd.h>
 
 #if USE_MPI == 1
 #include <mpi.h>
 #endif
 // applications do not require mpi.
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
 using namespace SymbolRetriever;
+using cgpatch::CallCount;
+using cgpatch::EdgeList;
 
 
 namespace {
@@ -42,14 +61,562 @@ void initializeGlobalCallgraph() {
   }
 }
 
+/**
+ * Descriptor of an instrumented call site, as emitted by CGPatchInstPass into the metacg_callsites section
+ */
+struct CallSiteDescriptor {
+  const char* caller;
+  const char* file;  // Null without debug information
+  uint32_t ordinal;  // Index of the call site among the instrumented ones of the caller
+  uint32_t line;
+  uint32_t column;
+};
+
+// Targets cached inline per call site, must match CGPatchInstPass
+constexpr std::size_t CallSiteCacheEntries = 2;
+
+/**
+ * The call-site table of an instrumented module, and its inline caches of the recorded targets. The cache has a row
+ * of CallSiteCacheEntries targets per call site.
+ */
+struct RegisteredCallSites {
+  const CallSiteDescriptor* table;
+  uint32_t size;
+  void** cache;
+};
+
+/**
+ * The call-site tables of the instrumented modules. Each module gets a dense range of IDs at registration.
+ */
+struct CallSiteRegistry {
+  std::mutex mutex;
+  std::map<uint32_t, RegisteredCallSites> tables;  // By first ID
+  uint32_t nextId = 0;
+};
+
+CallSiteRegistry& getCallSiteRegistry() {
+  // Never destroyed and usable before the static constructors of this file run, as modules register early
+  static auto* registry = new CallSiteRegistry();
+  return *registry;
+}
+
+const CallSiteDescriptor* findCallSite(uint32_t id) {
+  auto& registry = getCallSiteRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.tables.upper_bound(id);
+  if (it == registry.tables.begin()) {
+    return nullptr;
+  }
+  --it;
+  const auto& [table, size, cache] = it->second;
+  return id - it->first < size ? &table[id - it->first] : nullptr;
+}
+
+/**
+ * Drops the tables of unloaded modules and empties the caches of the others, as functions may be loaded at the
+ * addresses of cached targets later
+ */
+void resetCallSiteCaches() {
+  auto& registry = getCallSiteRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto it = registry.tables.begin(); it != registry.tables.end();) {
+    Dl_info info;
+    auto& [table, size, cache] = it->second;
+    if (!dladdr(table, &info)) {
+      it = registry.tables.erase(it);
+      continue;
+    }
+    // Tables registered without a cache have nothing to reset
+    for (std::size_t i = 0; cache && i < size * CallSiteCacheEntries; ++i) {
+      __atomic_store_n(&cache[i], nullptr, __ATOMIC_RELAXED);
+    }
+    ++it;
+  }
+}
+
+/**
+ * Adds a recorded target to the inline cache of its call site. Several threads may fill the same entries, a lost
+ * update only causes another call to the runtime.
+ */
+void fillCallSiteCache(void** entries, void* address) {
+  for (std::size_t i = 0; i < CallSiteCacheEntries; ++i) {
+    void* cached = __atomic_load_n(&entries[i], __ATOMIC_RELAXED);
+    if (cached == address) {
+      return;
+    }
+    if (!cached) {
+      __atomic_store_n(&entries[i], address, __ATOMIC_RELAXED);
+      return;
+    }
+  }
+  // More targets than entries, the first ones stay cached
+  __atomic_store_n(&entries[CallSiteCacheEntries - 1], address, __ATOMIC_RELAXED);
+}
+
+/**
+ * An indirect call observed at runtime: the ID of the call site and the address of the called function
+ */
+struct RecordedEdge {
+  uint32_t callSite;
+  void* target;
+
+  bool operator==(const RecordedEdge& other) const { return callSite == other.callSite && target == other.target; }
+};
+
+inline std::size_t hashEdge(uint32_t callSite, void* target) {
+  auto h = (callSite + 1) * 0x9e3779b97f4a7c15ull ^ reinterpret_cast<std::uintptr_t>(target);
+  h *= 0xff51afd7ed558ccdull;
+  return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+struct RecordedEdgeHash {
+  std::size_t operator()(const RecordedEdge& edge) const { return hashEdge(edge.callSite, edge.target); }
+};
+
+/**
+ * The distinct edges recorded by all threads. Only accessed when an edge is missing in the cache of a thread, the
+ * symbols are resolved and the edges are added to the call graph at finalization.
+ */
+struct EdgeRecorder {
+  std::mutex mutex;
+  std::unordered_set<RecordedEdge, RecordedEdgeHash> edges;
+};
+
+EdgeRecorder& getEdgeRecorder() {
+  // Never destroyed, as threads may still record edges while the static objects are destroyed
+  static auto* recorder = new EdgeRecorder();
+  return *recorder;
+}
+
+/**
+ * Enabled with the CGPATCH_CALL_COUNTS environment variable. Only checked when an edge is missing in the cache of a
+ * thread, as calls may be instrumented before the static objects of the runtime are initialized.
+ */
+bool isCountingCalls() {
+  static const bool countCalls = [] {
+    const char* envVal = std::getenv("CGPATCH_CALL_COUNTS");
+    return envVal && std::string(envVal) != "0";
+  }();
+  return countCalls;
+}
+
+uint64_t getNanosecondsSinceStart() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Calls of an edge by one thread. Only incremented by the owning thread, drained when the edges are materialized.
+ */
+struct EdgeCounter {
+  std::atomic<uint64_t> count{0};
+  uint64_t firstSeen = 0;  // Nanoseconds since the start of the runtime
+};
+
+/**
+ * The edge counters of one thread. The entries do not move, so the edge cache of the thread can point to them.
+ */
+struct ThreadEdgeCounters {
+  std::mutex mutex;
+  std::unordered_map<RecordedEdge, EdgeCounter, RecordedEdgeHash> counters;
+  // Calls that were not drained yet when the counters were cleared after an object was unloaded
+  std::unordered_map<RecordedEdge, CallCount, RecordedEdgeHash> pending;
+  bool exited = false;  // Guarded by the mutex of the registry
+};
+
+struct CounterRegistry {
+  std::mutex mutex;
+  std::vector<ThreadEdgeCounters*> threads;
+};
+
+CounterRegistry& getCounterRegistry() {
+  // Never destroyed, as threads may still count calls while the static objects are destroyed
+  static auto* registry = new CounterRegistry();
+  return *registry;
+}
+
+/**
+ * Registers the counters of a thread on first use. They are released at the next materialization after the thread
+ * exited.
+ */
+struct ThreadCountersHandle {
+  ThreadEdgeCounters* counters = nullptr;
+
+  ThreadEdgeCounters& get() {
+    if (!counters) {
+      counters = new ThreadEdgeCounters();
+      auto& registry = getCounterRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.threads.push_back(counters);
+    }
+    return *counters;
+  }
+
+  ~ThreadCountersHandle() {
+    if (counters) {
+      auto& registry = getCounterRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      counters->exited = true;
+    }
+  }
+};
+thread_local ThreadCountersHandle threadCounters;
+
+EdgeCounter& getThreadEdgeCounter(uint32_t callSite, void* target) {
+  auto& counters = threadCounters.get();
+  std::lock_guard<std::mutex> lock(counters.mutex);
+  auto [it, inserted] = counters.counters.try_emplace({callSite, target});
+  if (inserted) {
+    it->second.firstSeen = getNanosecondsSinceStart();
+  }
+  return it->second;
+}
+
+/**
+ * Sums the calls counted by all threads since the last call
+ */
+std::unordered_map<RecordedEdge, CallCount, RecordedEdgeHash> drainCallCounts() {
+  std::unordered_map<RecordedEdge, CallCount, RecordedEdgeHash> callCounts;
+  auto& registry = getCounterRegistry();
+  std::lock_guard<std::mutex> registryLock(registry.mutex);
+  for (auto it = registry.threads.begin(); it != registry.threads.end();) {
+    auto* thread = *it;
+    {
+      std::lock_guard<std::mutex> lock(thread->mutex);
+      for (auto& [edge, counter] : thread->counters) {
+        if (const auto count = counter.count.exchange(0, std::memory_order_relaxed); count != 0) {
+          callCounts[edge].add(count, counter.firstSeen);
+        }
+      }
+      for (const auto& [edge, pending] : thread->pending) {
+        callCounts[edge].add(pending.count, pending.firstSeen);
+      }
+      thread->pending.clear();
+    }
+    if (thread->exited) {
+      delete thread;
+      it = registry.threads.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return callCounts;
+}
+
+/**
+ * Recently recorded edges of a thread. Open addressing with a bounded probe sequence, if all probed slots are taken
+ * the first one is overwritten. Empty slots have no target. Zero initialized and trivially destructible, so no guard
+ * is needed on access.
+ */
+struct CachedEdge {
+  uint32_t callSite;
+  void* target;
+  EdgeCounter* counter;  // Null if calls are not counted
+};
+constexpr std::size_t EdgeCacheSize = 1024;  // Power of two
+constexpr std::size_t EdgeCacheProbes = 4;
+thread_local CachedEdge edgeCache[EdgeCacheSize];
+
+// Incremented when an object is unloaded. Another function may be loaded at the address of a cached target later, so
+// the caches and counters of all threads are cleared. Counts that were not drained yet are kept until the next drain.
+std::atomic<uint32_t> unloadEpoch{0};
+thread_local uint32_t edgeCacheEpoch;
+
+/**
+ * The number of objects the dynamic linker has loaded and unloaded so far, empty if it does not provide them
+ */
+std::optional<std::pair<unsigned long long, unsigned long long>> getLoadCounters() {
+  std::optional<std::pair<unsigned long long, unsigned long long>> counters;
+  dl_iterate_phdr(
+      [](dl_phdr_info* info, std::size_t size, void* data) {
+        // The counters are the same for all objects
+        if (size >= offsetof(dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs)) {
+          static_cast<decltype(counters)*>(data)->emplace(info->dlpi_adds, info->dlpi_subs);
+        }
+        return 1;
+      },
+      &counters);
+  return counters;
+}
+
+// The load counters when the symbol tables were last updated. Guarded by materializeMutex.
+std::optional<std::pair<unsigned long long, unsigned long long>> symTablesLoadCounters;
+// Edges are added to the graph at finalization, before objects are unloaded and by the edge log writer, possibly from
+// several threads
+std::mutex materializeMutex;
+bool finalized = false;
+
+/**
+ * State of the edge log, enabled by CGPATCH_EDGE_LOG. The writer thread periodically appends the edges found since
+ * its last flush, so the edges of a process that terminates abnormally are kept up to the last flush.
+ */
+struct EdgeLogState {
+  int fd = -1;
+  std::chrono::milliseconds interval{1000};
+  EdgeList pending;  // Guarded by materializeMutex
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  bool stopping = false;
+  std::thread writer;
+};
+
+EdgeLogState& getEdgeLog() {
+  // Leaked, the writer is stopped at finalization and may run until then
+  static auto* edgeLog = new EdgeLogState();
+  return *edgeLog;
+}
+
+bool isLoggingEdges() { return getEdgeLog().fd >= 0; }
+
+void recordEdge(CachedEdge& slot, uint32_t callSite, void* target) {
+  {
+    auto& recorder = getEdgeRecorder();
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    recorder.edges.insert({callSite, target});
+  }
+  slot = {callSite, target, isCountingCalls() ? &getThreadEdgeCounter(callSite, target) : nullptr};
+  if (slot.counter) {
+    slot.counter->count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void clearEdgeCache() {
+  std::fill(std::begin(edgeCache), std::end(edgeCache), CachedEdge{0, nullptr, nullptr});
+  if (threadCounters.counters) {
+    auto& counters = *threadCounters.counters;
+    std::lock_guard<std::mutex> lock(counters.mutex);
+    // Calls counted since the last drain, e.g., between the drain before an object was unloaded and the epoch change
+    for (auto& [edge, counter] : counters.counters) {
+      if (const auto count = counter.count.exchange(0, std::memory_order_relaxed); count != 0) {
+        counters.pending[edge].add(count, counter.firstSeen);
+      }
+    }
+    counters.counters.clear();
+  }
+}
+
+/**
+ * Records the edge, unless the calling thread has already recorded it, and counts the call
+ */
+void observeCall(uint32_t callSite, void* address) {
+  if (const auto epoch = unloadEpoch.load(std::memory_order_relaxed); epoch != edgeCacheEpoch) {
+    clearEdgeCache();
+    edgeCacheEpoch = epoch;
+  }
+  // Hot path: most calls repeat an edge the calling thread has already recorded
+  const auto first = hashEdge(callSite, address);
+  for (std::size_t probe = 0; probe < EdgeCacheProbes; ++probe) {
+    auto& slot = edgeCache[(first + probe) & (EdgeCacheSize - 1)];
+    if (slot.callSite == callSite && slot.target == address) {
+      if (slot.counter) {
+        slot.counter->count.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+    if (!slot.target) {
+      recordEdge(slot, callSite, address);
+      return;
+    }
+  }
+  recordEdge(edgeCache[first & (EdgeCacheSize - 1)], callSite, address);
+}
+
+/**
+ * Adds the edges recorded since the last call to the global call graph, and the calls counted since then to their
+ * metadata
+ */
+void materializeRecordedEdges() {
+  std::lock_guard<std::mutex> materializeLock(materializeMutex);
+  initializeGlobalCallgraph();
+  if (!globalCallgraph) {
+    metacg::MCGLogger::logError("globalCallgraph is not initialized.");
+    return;
+  }
+
+  std::vector<RecordedEdge> edges;
+  {
+    auto& recorder = getEdgeRecorder();
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    edges.assign(recorder.edges.begin(), recorder.edges.end());
+    recorder.edges.clear();
+  }
+  // Counted edges may have been recorded after the recorder was drained
+  auto callCounts = drainCallCounts();
+  for (const auto& [edge, callCount] : callCounts) {
+    edges.push_back(edge);
+  }
+  if (edges.empty()) {
+    return;
+  }
+
+  // Only reads the objects loaded since the last update. Objects are not tracked through dlopen, as an interposed
+  // dlopen would become the caller whose RUNPATH and $ORIGIN the dynamic linker uses.
+  if (const auto loadCounters = getLoadCounters(); !loadCounters || loadCounters != symTablesLoadCounters) {
+    updateMappedSymTables(symTables);
+    symTablesLoadCounters = loadCounters;
+  }
+
+  // Targets are usually called from several call sites
+  std::unordered_map<void*, std::string> symbols;
+  for (const auto& edge : edges) {
+    const auto* callSite = findCallSite(edge.callSite);
+    if (!callSite) {
+      metacg::MCGLogger::logError("Unknown call site {}", edge.callSite);
+      continue;
+    }
+
+    auto [symbolIt, inserted] = symbols.try_emplace(edge.target);
+    if (inserted) {
+      symbolIt->second = findSymbol(reinterpret_cast<std::uintptr_t>(edge.target), symTables);
+    }
+    const auto& symbol = symbolIt->second;
+    if (symbol.empty()) {
+      if (inserted) {
+        metacg::MCGLogger::logError("Could not find symbol for address {:#x}",
+                                    reinterpret_cast<std::uintptr_t>(edge.target));
+      }
+      continue;
+    }
+
+    metacg::CgNode& caller = globalCallgraph->getOrInsertNode(callSite->caller);
+    metacg::CgNode& callee = globalCallgraph->getOrInsertNode(symbol);
+    // Add new edge if edge does not exist yet
+    if (!globalCallgraph->existsEdge(caller.getId(), callee.getId())) {
+      // set hasBody to true so the call-graphs can be fully merged
+      caller.setHasBody(true);
+      callee.setHasBody(true);
+
+      globalCallgraph->addEdge(caller, callee);
+      counter++;
+    }
+
+    // Several call sites of a caller may call the same function
+    CallCount callCount;
+    if (const auto countIt = callCounts.find(edge); countIt != callCounts.end()) {
+      callCount = countIt->second;
+      callCounts.erase(countIt);
+      const std::pair<metacg::NodeId, metacg::NodeId> id{caller.getId(), callee.getId()};
+      if (auto* md = globalCallgraph->getEdgeMetaData(id, metacg::RuntimeCallCountMD::key)) {
+        static_cast<metacg::RuntimeCallCountMD*>(md)->add(callCount.count, callCount.firstSeen);
+      } else {
+        globalCallgraph->addEdgeMetaData(
+            id, std::make_unique<metacg::RuntimeCallCountMD>(callCount.count, callCount.firstSeen));
+      }
+    }
+    // The log holds the calls counted since the previous block
+    if (isLoggingEdges()) {
+      getEdgeLog().pending.addEdge(callSite->caller, symbol, callCount);
+    }
+  }
+}
+
+/**
+ * Appends the edges found since the last flush to the edge log as a single block
+ */
+void flushEdgeLog() {
+  auto& edgeLog = getEdgeLog();
+  materializeRecordedEdges();
+  EdgeList edges;
+  {
+    std::lock_guard<std::mutex> materializeLock(materializeMutex);
+    std::swap(edges, edgeLog.pending);
+  }
+  if (edges.empty()) {
+    return;
+  }
+
+  const auto block = cgpatch::createEdgeLogBlock(edges);
+  std::size_t written = 0;
+  while (written < block.size()) {
+    const auto ret = ::write(edgeLog.fd, block.data() + written, block.size() - written);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      metacg::MCGLogger::logError("Unable to write to the edge log: {}", std::strerror(errno));
+      return;
+    }
+    written += static_cast<std::size_t>(ret);
+  }
+}
+
+void startEdgeLogWriter() {
+  const char* path = std::getenv("CGPATCH_EDGE_LOG");
+  if (!path || !*path) {
+    return;
+  }
+  // Every process writes its own log, e.g., the ranks of an MPI application
+  std::string filename(path);
+  for (auto pos = filename.find("%p"); pos != std::string::npos; pos = filename.find("%p", pos)) {
+    const auto pid = std::to_string(getpid());
+    filename.replace(pos, 2, pid);
+    pos += pid.size();
+  }
+
+  auto& edgeLog = getEdgeLog();
+  edgeLog.fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+  if (edgeLog.fd < 0) {
+    metacg::MCGLogger::logError("Unable to open edge log {}: {}", filename, std::strerror(errno));
+    return;
+  }
+  if (const char* interval = std::getenv("CGPATCH_EDGE_LOG_INTERVAL")) {
+    if (const auto ms = std::strtoul(interval, nullptr, 10); ms > 0) {
+      edgeLog.interval = std::chrono::milliseconds(ms);
+    }
+  }
+
+  edgeLog.writer = std::thread([&edgeLog]() {
+    std::unique_lock<std::mutex> lock(edgeLog.mutex);
+    while (!edgeLog.wakeUp.wait_for(lock, edgeLog.interval, [&edgeLog]() { return edgeLog.stopping; })) {
+      lock.unlock();
+      flushEdgeLog();
+      lock.lock();
+    }
+  });
+}
+
+/**
+ * Stops the writer thread and appends the remaining edges
+ */
+void stopEdgeLogWriter() {
+  auto& edgeLog = getEdgeLog();
+  if (!isLoggingEdges()) {
+    return;
+  }
+  if (edgeLog.writer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(edgeLog.mutex);
+      edgeLog.stopping = true;
+    }
+    edgeLog.wakeUp.notify_one();
+    edgeLog.writer.join();
+  }
+  flushEdgeLog();
+  close(edgeLog.fd);
+}
+
 void finalizeGlobalCallgraph() {
+  stopEdgeLogWriter();
+  materializeRecordedEdges();
+  {
+    std::lock_guard<std::mutex> materializeLock(materializeMutex);
+    finalized = true;
+  }
+
   // Write Callgraph to file
   // TODO: allow user to set format version
   metacg::graph::MCGManager& mcgManager = metacg::graph::MCGManager::get();
   if (shouldWrite) {
-    metacg::io::VersionTwoMCGWriter mcgWriter;
     metacg::io::JsonSink jsonSink;
-    mcgWriter.write(mcgManager.getCallgraph(), jsonSink);
+    if (isCountingCalls()) {
+      // Edge metadata requires format version 4
+      metacg::io::VersionFourMCGWriter mcgWriter;
+      mcgWriter.setUseNamesAsIds(true);
+      mcgWriter.write(mcgManager.getCallgraph(), jsonSink);
+    } else {
+      metacg::io::VersionTwoMCGWriter mcgWriter;
+      mcgWriter.write(mcgManager.getCallgraph(), jsonSink);
+    }
     nlohmann::json j = jsonSink.getJson();
 
     const char* envVal = std::getenv("CGPATCH_CG_NAME");
@@ -74,6 +641,9 @@ void finalizeGlobalCallgraph() {
 struct ValidatorInitializer {
   ValidatorInitializer() {
     initializeGlobalCallgraph();
+    // First observations of edges are measured from here
+    getNanosecondsSinceStart();
+    startEdgeLogWriter();
   }
 
   ValidatorInitializer(const ValidatorInitializer&) = delete;
@@ -86,96 +656,91 @@ struct ValidatorInitializer {
 } _validator_init_finalize;
 }  // namespace
 
-extern "C" void __metacg_indirect_call(const char* name, void* address) {
-  static std::unordered_map<const char*, std::unordered_set<void*>> visitedMap;
-  if (!globalCallgraph) {
-    metacg::MCGLogger::logError("globalCallgraph is not initialized.");
-    return;
-  }
-  auto& knownCalls = visitedMap[name];
-  if (knownCalls.find(address) != knownCalls.end()) {
-    // We have seen this edge before
-    return;
-  }
-  knownCalls.insert(address);
-
-  // static ValidatorInitializer validator_init;
-  initializeGlobalCallgraph();
+extern "C" void __metacg_register_call_sites(const CallSiteDescriptor* table, uint32_t size, uint32_t* firstId,
+                                             void** cache) {
+  auto& registry = getCallSiteRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  *firstId = registry.nextId;
+  registry.tables.emplace(registry.nextId, RegisteredCallSites{table, size, cache});
+  registry.nextId += size;
+}
 
-  // resolve name
-  // Loads symTables if symTables is not initialized yet. This potentially runs before the static constructor
-  if (symTables.empty()) {
-    symTables = loadMappedSymTables(getExecPath());
+/**
+ * Called by instrumented call sites whose target is not cached. The older entry point __metacg_indirect_call took the
+ * name of the caller instead of a call-site ID and is intentionally not provided.
+ */
+extern "C" void __metacg_indirect_call_site(uint32_t callSite, void* address, void** cacheEntries) {
+  observeCall(callSite, address);
+  // Counted calls must keep calling the runtime
+  if (cacheEntries && !isCountingCalls()) {
+    fillCallSiteCache(cacheEntries, address);
   }
+}
 
-  const std::string& symbol = findSymbol(reinterpret_cast<std::uintptr_t>(address), symTables);
-  if (symbol.empty()) {
-    metacg::MCGLogger::logError("Could not find symbol for address {:#x}", reinterpret_cast<std::uintptr_t>(address));
-    return;
+extern "C" int dlclose(void* handle) noexcept {
+  static auto* realDlclose = reinterpret_cast<int (*)(void*)>(dlsym(RTLD_NEXT, "dlclose"));
+  // Targets in the object can only be resolved while it is loaded, and the call-site tables of its instrumented
+  // functions are part of it
+  bool isFinalized;
+  {
+    std::lock_guard<std::mutex> materializeLock(materializeMutex);
+    isFinalized = finalized;
   }
-
-  // Add new edge if edge does not exist yet
-  if (!globalCallgraph->existsAnyEdge(name, symbol)) {
-    metacg::CgNode& caller = globalCallgraph->getOrInsertNode(name);
-    metacg::CgNode& callee = globalCallgraph->getOrInsertNode(symbol);
-
-    // set hasBody to true so the call-graphs can be fully merged
-    caller.setHasBody(true);
-    callee.setHasBody(true);
-
-    globalCallgraph->addEdge(caller, callee);
-    counter++;
-
-    return;
+  if (!isFinalized) {
+    materializeRecordedEdges();
   }
+  const int ret = realDlclose(handle);
+  ++unloadEpoch;
+  resetCallSiteCaches();
+  return ret;
 }
 
 #if USE_MPI == 1
 
 extern "C" int MPI_Finalize(void) {
-  metacg::graph::MCGManager& mcgManager = metacg::graph::MCGManager::get();
+  materializeRecordedEdges();
 
   int localRank, totalRanks;
   MPI_Comm_rank(MPI_COMM_WORLD, &localRank);
   MPI_Comm_size(MPI_COMM_WORLD, &totalRanks);
-
-  if (localRank != 0) {
-    shouldWrite = false;
-    // serialize call-graph
-    metacg::io::VersionTwoMCGWriter mcgWriter;
-    metacg::io::JsonSink jsonSink;
-    mcgWriter.write(globalCallgraph, jsonSink);
-    nlohmann::json j = jsonSink.getJson();
-
-    // Send all call-graphs to rank 0
-    std::string jsonStr = j.dump();
-    MPI_Send(jsonStr.data(), jsonStr.size(), MPI_CHAR, 0, 0, MPI_COMM_WORLD);
-  } else if (localRank == 0) {
-    shouldWrite = true;
+  // Messages of the application that are still in flight cannot be mistaken for call graphs
+  MPI_Comm comm;
+  MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+
+  // Binomial tree reduction to rank 0: in round k, the ranks with bit k set send the edges of their subtree to
+  // rank - 2^k and are done, the others receive from rank + 2^k. Takes log2(ranks) rounds.
+  // The edge log writer may still add edges
+  std::unique_lock<std::mutex> materializeLock(materializeMutex);
+  auto edges = EdgeList::fromCallgraph(*globalCallgraph);
+  materializeLock.unlock();
+  for (int mask = 1; mask < totalRanks; mask <<= 1) {
+    if (localRank & mask) {
+      const auto buffer = edges.serialize();
+      MPI_Send(buffer.data(), static_cast<int>(buffer.size()), MPI_BYTE, localRank - mask, 0, comm);
+      break;
+    }
+    const int child = localRank + mask;
+    if (child >= totalRanks) {
+      continue;
+    }
     MPI_Status status;
     int msgSize;
-
-    for (int i = 1; i < totalRanks; i++) {
-      // Probe for incoming message
-      MPI_Probe(i, 0, MPI_COMM_WORLD, &status);
-
-      // Get size of incoming message
-      MPI_Get_count(&status, MPI_CHAR, &msgSize);
-
-      // Allocate buffer & receive message
-      std::vector<char> buffer(msgSize);
-      MPI_Recv(buffer.data(), msgSize, MPI_CHAR, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-      // Deserialize call-graph and add to mcgManager
-      std::string jsonStr(buffer.begin(), buffer.end());
-      nlohmann::json j = nlohmann::json::parse(jsonStr);
-      metacg::io::JsonSource jsonSource(j);
-      metacg::io::VersionTwoMCGReader mcgReader(jsonSource);
-
-      mcgManager.addToManagedGraphs(std::to_string(i), std::move(mcgReader.read()), false);
+    MPI_Probe(child, 0, comm, &status);
+    MPI_Get_count(&status, MPI_BYTE, &msgSize);
+    std::vector<char> buffer(msgSize);
+    MPI_Recv(buffer.data(), msgSize, MPI_BYTE, child, 0, comm, MPI_STATUS_IGNORE);
+    if (!edges.merge(buffer.data(), buffer.size())) {
+      metacg::MCGLogger::logError("Malformed call graph received from rank {}", child);
     }
+  }
+  MPI_Comm_free(&comm);
 
-    mcgManager.mergeIntoActiveGraph(metacg::MergeByName());
+  shouldWrite = localRank == 0;
+  if (shouldWrite) {
+    materializeLock.lock();
+    edges.addToCallgraph(*globalCallgraph);
+    // PMPI_Finalize unloads components
+    materializeLock.unlock();
   }
   return PMPI_Finalize();
 }
@@ -6,12 +6,24 @@
 
 #include "SymbolRetriever.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <elf.h>
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <link.h>
+#include <numeric>
+#include <optional>
 #include <sstream>
+#include <string_view>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 
 namespace SymbolRetriever {
@@ -38,32 +50,238 @@ struct RemoveEnvInScope {
   const char* oldVal;
 };
 
-uintptr_t getTextSectionOffsetFromLibrary(const std::string& lib_path) {
-  int fd = open(lib_path.c_str(), O_RDONLY);
-  if (fd < 0) {
-    perror("open");
-    return 0;
+/**
+ * A read-only mapping of an ELF64 object file. All accessors check that the requested range lies within the file.
+ */
+class ElfFile {
+ public:
+  explicit ElfFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Elf64_Ehdr)) {
+      void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        data = static_cast<const char*>(mapping);
+        size = st.st_size;
+      }
+    }
+    close(fd);
+
+    if (data && (std::memcmp(data, ELFMAG, SELFMAG) != 0 || data[EI_CLASS] != ELFCLASS64)) {
+      munmap(const_cast<char*>(data), size);
+      data = nullptr;
+    }
+  }
+
+  ~ElfFile() {
+    if (data) {
+      munmap(const_cast<char*>(data), size);
+    }
+  }
+
+  ElfFile(const ElfFile&) = delete;
+  ElfFile& operator=(const ElfFile&) = delete;
+
+  bool isValid() const { return data != nullptr; }
+
+  const Elf64_Ehdr& getHeader() const { return *reinterpret_cast<const Elf64_Ehdr*>(data); }
+
+  /**
+   * @return Pointer to count entries of type T at offset, nullptr if they exceed the file
+   */
+  template <typename T>
+  const T* getArray(uint64_t offset, uint64_t count) const {
+    if (offset > size || count > (size - offset) / sizeof(T)) {
+      return nullptr;
+    }
+    return reinterpret_cast<const T*>(data + offset);
+  }
+
+  const Elf64_Phdr* getProgramHeaders() const {
+    const auto& header = getHeader();
+    return header.e_phentsize == sizeof(Elf64_Phdr) ? getArray<Elf64_Phdr>(header.e_phoff, header.e_phnum) : nullptr;
+  }
+
+  const Elf64_Shdr* getSectionHeaders() const {
+    const auto& header = getHeader();
+    return header.e_shentsize == sizeof(Elf64_Shdr) ? getArray<Elf64_Shdr>(header.e_shoff, header.e_shnum) : nullptr;
+  }
+
+  /**
+   * @return The null-terminated string at offset of the given string table, nullopt if it exceeds the table
+   */
+  std::optional<std::string_view> getString(const Elf64_Shdr& strtab, uint64_t offset) const {
+    const auto* strings = getArray<char>(strtab.sh_offset, strtab.sh_size);
+    if (!strings || offset >= strtab.sh_size) {
+      return std::nullopt;
+    }
+    const auto* begin = strings + offset;
+    const auto* end = static_cast<const char*>(std::memchr(begin, '\0', strtab.sh_size - offset));
+    if (!end) {
+      return std::nullopt;
+    }
+    return std::string_view(begin, end - begin);
+  }
+
+  const Elf64_Shdr* findSection(std::string_view name) const {
+    const auto* sections = getSectionHeaders();
+    const auto& header = getHeader();
+    if (!sections || header.e_shstrndx >= header.e_shnum) {
+      return nullptr;
+    }
+    for (unsigned i = 0; i < header.e_shnum; ++i) {
+      if (getString(sections[header.e_shstrndx], sections[i].sh_name) == name) {
+        return &sections[i];
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Calls callback(symbol, name) for the defined symbols of the first section of the given type, e.g., SHT_SYMTAB or
+   * SHT_DYNSYM. Symbols referring to versioned definitions of shared objects may carry the version, it is removed.
+   * @return false if there is no such section
+   */
+  template <typename Callback>
+  bool forEachDefinedSymbol(uint32_t sectionType, Callback&& callback) const {
+    const auto* sections = getSectionHeaders();
+    if (!sections) {
+      return false;
+    }
+    const auto numSections = getHeader().e_shnum;
+    for (unsigned i = 0; i < numSections; ++i) {
+      const auto& section = sections[i];
+      if (section.sh_type != sectionType || section.sh_entsize != sizeof(Elf64_Sym) || section.sh_link >= numSections) {
+        continue;
+      }
+      const auto numSymbols = section.sh_size / sizeof(Elf64_Sym);
+      const auto* symbols = getArray<Elf64_Sym>(section.sh_offset, numSymbols);
+      if (!symbols) {
+        return false;
+      }
+      for (uint64_t s = 0; s < numSymbols; ++s) {
+        const auto& symbol = symbols[s];
+        const auto type = ELF64_ST_TYPE(symbol.st_info);
+        // Same selection as nm --defined-only, which was used before
+        if (symbol.st_shndx == SHN_UNDEF || type == STT_SECTION || type == STT_FILE || symbol.st_name == 0) {
+          continue;
+        }
+        if (const auto name = getString(sections[section.sh_link], symbol.st_name)) {
+          callback(symbol, name->substr(0, name->find('@')));
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool readSymbols(uint32_t sectionType, SymbolTable& table) const {
+    return forEachDefinedSymbol(sectionType, [&table](const Elf64_Sym& symbol, std::string_view name) {
+      // nm lists aliases sorted by name and the last one was kept, so aliases still resolve to the same name
+      auto [it, inserted] = table.try_emplace(symbol.st_value, name);
+      if (!inserted && it->second < name) {
+        it->second.assign(name);
+      }
+    });
   }
 
-  Elf64_Ehdr ehdr;
-  read(fd, &ehdr, sizeof(ehdr));
+  bool readSymbols(uint32_t sectionType, SymbolIndex& index) const {
+    return forEachDefinedSymbol(sectionType, [&index](const Elf64_Sym& symbol, std::string_view name) {
+      index.add(symbol.st_value, symbol.st_size, name);
+    });
+  }
+
+  /**
+   * Names the entries that call external functions through the GOT after the function
+   */
+  void readPltEntries(SymbolIndex& index) const {
+    const auto* sections = getSectionHeaders();
+    if (!sections) {
+      return;
+    }
+    const auto numSections = getHeader().e_shnum;
 
-  lseek(fd, ehdr.e_phoff, SEEK_SET);
+    // The address of an external function taken in a non-PIE executable is its PLT entry, the dynamic symbol records it
+    const auto* dynsym = findSection(".dynsym");
+    if (!dynsym || dynsym->sh_entsize != sizeof(Elf64_Sym) || dynsym->sh_link >= numSections) {
+      return;
+    }
+    const auto numSymbols = dynsym->sh_size / sizeof(Elf64_Sym);
+    const auto* symbols = getArray<Elf64_Sym>(dynsym->sh_offset, numSymbols);
+    if (!symbols) {
+      return;
+    }
+    const auto getName = [&](uint64_t symbolIndex) -> std::optional<std::string_view> {
+      if (symbolIndex >= numSymbols || symbols[symbolIndex].st_name == 0) {
+        return std::nullopt;
+      }
+      const auto name = getString(sections[dynsym->sh_link], symbols[symbolIndex].st_name);
+      return name ? std::optional(name->substr(0, name->find('@'))) : std::nullopt;
+    };
+    for (uint64_t s = 0; s < numSymbols; ++s) {
+      const auto& symbol = symbols[s];
+      if (symbol.st_shndx == SHN_UNDEF && symbol.st_value != 0 && ELF64_ST_TYPE(symbol.st_info) == STT_FUNC) {
+        if (const auto name = getName(s)) {
+          index.add(symbol.st_value, 0, *name);
+        }
+      }
+    }
 
-  Elf64_Phdr phdr;
-  uintptr_t text_offset = 0;
-  for (int i = 0; i < ehdr.e_phnum; i++) {
-    read(fd, &phdr, sizeof(phdr));
+    // The layout of the lazy binding entries is specific to the architecture
+    if (getHeader().e_machine != EM_X86_64) {
+      return;
+    }
+    const auto* relocationSection = findSection(".rela.plt");
+    // With indirect branch tracking, the entries that are called are in .plt.sec, .plt only holds the binding stubs
+    const auto* pltSec = findSection(".plt.sec");
+    const auto* plt = pltSec ? pltSec : findSection(".plt");
+    if (!relocationSection || !plt || relocationSection->sh_entsize != sizeof(Elf64_Rela)) {
+      return;
+    }
+    const auto numRelocations = relocationSection->sh_size / sizeof(Elf64_Rela);
+    const auto* relocations = getArray<Elf64_Rela>(relocationSection->sh_offset, numRelocations);
+    if (!relocations) {
+      return;
+    }
+    constexpr uint64_t PltEntrySize = 16;
+    // .plt starts with the entry that calls the dynamic linker
+    const uint64_t firstEntry = plt->sh_addr + (pltSec ? 0 : PltEntrySize);
+    for (uint64_t r = 0; r < numRelocations; ++r) {
+      if (ELF64_R_TYPE(relocations[r].r_info) != R_X86_64_JUMP_SLOT) {
+        continue;
+      }
+      if (const auto name = getName(ELF64_R_SYM(relocations[r].r_info))) {
+        index.add(firstEntry + r * PltEntrySize, PltEntrySize, *name);
+      }
+    }
+  }
 
+ private:
+  const char* data = nullptr;
+  std::size_t size = 0;
+};
+
+uintptr_t getTextSectionOffsetFromLibrary(const std::string& lib_path) {
+  ElfFile elf(lib_path);
+  if (!elf.isValid()) {
+    errConsole->error("Unable to read ELF file {}", lib_path);
+    return 0;
+  }
+  const auto* phdrs = elf.getProgramHeaders();
+  if (!phdrs) {
+    return 0;
+  }
+  for (int i = 0; i < elf.getHeader().e_phnum; i++) {
+    const auto& phdr = phdrs[i];
     if (phdr.p_type == PT_LOAD && (phdr.p_flags & PF_X)) {
       // Found the executable segment in the shared library
-      text_offset = phdr.p_vaddr - phdr.p_offset;
-      break;
+      return phdr.p_vaddr - phdr.p_offset;
     }
   }
-
-  close(fd);
-  return text_offset;
+  return 0;
 }
 
 std::string getExecPath() {
@@ -117,8 +335,22 @@ std::vector<MemMapEntry> readMemoryMap() {
 }
 
 std::vector<std::string> readSharedObjectDependencies(const std::string& exec_file) {
-  RemoveEnvInScope removePreload("LD_PRELOAD");
   std::vector<std::string> dsoFiles;
+  if (exec_file == getExecPath()) {
+    // The dependencies of the running process are already loaded, no need to run ldd
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t, void* data) {
+          // Skips the executable itself and the vDSO, which have no path
+          if (info->dlpi_name && info->dlpi_name[0] == '/') {
+            static_cast<std::vector<std::string>*>(data)->emplace_back(info->dlpi_name);
+          }
+          return 0;
+        },
+        &dsoFiles);
+    return dsoFiles;
+  }
+
+  RemoveEnvInScope removePreload("LD_PRELOAD");
 
   std::string command = "ldd " + exec_file;
 
@@ -148,72 +380,144 @@ std::vector<std::string> readSharedObjectDependencies(const std::string& exec_fi
 }
 
 SymbolTable loadSymbolTable(const std::string& object_file) {
-  // Need to disable LD_PRELOAD, otherwise this library will be loaded in popen call, if linked dynamically
-  RemoveEnvInScope removePreload("LD_PRELOAD");
+  SymbolTable table;
+  ElfFile elf(object_file);
+  if (!elf.isValid()) {
+    errConsole->error("Unable to read ELF file {}", object_file);
+    return table;
+  }
 
-  std::string command = "nm --defined-only ";
-  if (object_file.find(".so") != std::string::npos) {
-    command += "-D ";
+  // Shared objects are usually stripped, so their exported symbols are used. Falls back to the other table if missing.
+  const uint32_t preferred = object_file.find(".so") != std::string::npos ? SHT_DYNSYM : SHT_SYMTAB;
+  if (!elf.readSymbols(preferred, table)) {
+    elf.readSymbols(preferred == SHT_DYNSYM ? SHT_SYMTAB : SHT_DYNSYM, table);
   }
-  command += object_file;
 
-  char buffer[256] = {0};
-  FILE* output = popen(command.c_str(), "r");
-  if (!output) {
-    errConsole->error("Unable to execute nm to resolve symbol names.");
-    return {};
+  if (table.empty()) {
+    errConsole->error("Unable to resolve symbol names for binary {}", object_file);
   }
 
-  SymbolTable table;
+  return table;
+}
 
-  uintptr_t addr;
-  std::string symType;
-  std::string symName;
+void SymbolIndex::add(uint64_t start, uint64_t size, std::string_view name) {
+  starts.push_back(start);
+  entries.push_back({size, static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size()), 0});
+  names.append(name);
+}
 
-  while (fgets(buffer, sizeof(buffer), output)) {
-    std::istringstream line(buffer);
-    if (buffer[0] != '0') {
+void SymbolIndex::finalize() {
+  const auto getName = [this](const Entry& entry) {
+    return std::string_view(names).substr(entry.nameOffset, entry.nameLength);
+  };
+  // Aliases sorted by descending name, so the first one is kept
+  std::vector<uint32_t> order(starts.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    if (starts[a] != starts[b]) {
+      return starts[a] < starts[b];
+    }
+    return getName(entries[a]) > getName(entries[b]);
+  });
+
+  std::vector<uint64_t> sortedStarts;
+  std::vector<Entry> sortedEntries;
+  std::string sortedNames;
+  sortedStarts.reserve(order.size());
+  sortedEntries.reserve(order.size());
+  // Symbols whose range has not ended yet, innermost last
+  std::vector<uint32_t> open;
+  for (const auto i : order) {
+    if (!sortedStarts.empty() && sortedStarts.back() == starts[i]) {
+      auto& alias = sortedEntries.back();
+      alias.size = std::max(alias.size, entries[i].size);
       continue;
     }
-    line >> std::hex >> addr;
-    line >> symType;
-    line >> symName;
-    table[addr] = symName;
+    const auto name = getName(entries[i]);
+    const auto id = static_cast<uint32_t>(sortedStarts.size());
+    while (!open.empty() && sortedStarts[open.back()] + sortedEntries[open.back()].size <= starts[i]) {
+      open.pop_back();
+    }
+    sortedStarts.push_back(starts[i]);
+    const auto enclosing = open.empty() ? id : open.back();
+    sortedEntries.push_back(
+        {entries[i].size, static_cast<uint32_t>(sortedNames.size()), entries[i].nameLength, enclosing});
+    sortedNames.append(name);
+    if (entries[i].size > 0) {
+      open.push_back(id);
+    }
   }
-  pclose(output);
+  starts = std::move(sortedStarts);
+  entries = std::move(sortedEntries);
+  names = std::move(sortedNames);
+}
 
-  if (table.empty()) {
-    errConsole->error("Unable to resolve symbol names for binary {}", object_file);
+std::string_view SymbolIndex::find(uint64_t addr) const {
+  if (starts.empty() || addr < starts.front()) {
+    return {};
   }
-
-  return table;
+  // Branchless search for the last symbol that starts at or before the address
+  const uint64_t* base = starts.data();
+  for (auto n = starts.size(); n > 1;) {
+    const auto half = n / 2;
+    base = base[half] <= addr ? base + half : base;
+    n -= half;
+  }
+  const auto index = static_cast<std::size_t>(base - starts.data());
+  const auto contains = [&](std::size_t i) {
+    return addr == starts[i] || addr - starts[i] < entries[i].size;
+  };
+  // Falls back to the symbol the found one is nested in, e.g., a label inside of a function
+  const auto found = contains(index) ? index : entries[index].enclosing;
+  if (!contains(found)) {
+    return {};
+  }
+  return std::string_view(names).substr(entries[found].nameOffset, entries[found].nameLength);
 }
 
-std::string getELFType(const std::string& object_file) {
-  // Need to disable LD_PRELOAD, otherwise this library will be loaded in popen call, if linked dynamically
-  RemoveEnvInScope removePreload("LD_PRELOAD");
-
-  std::string command = "llvm-readelf -h ";
-  command += object_file;
-  command += " | grep Type";
+SymbolIndex loadSymbolIndex(const std::string& object_file) {
+  SymbolIndex index;
+  ElfFile elf(object_file);
+  if (!elf.isValid()) {
+    errConsole->error("Unable to read ELF file {}", object_file);
+    return index;
+  }
 
-  char buffer[256] = {0};
-  FILE* output = popen(command.c_str(), "r");
-  if (!output) {
-    errConsole->error("Unable to execute llvm-readelf.");
-    return {};
+  // Same tables as for loadSymbolTable
+  const uint32_t preferred = object_file.find(".so") != std::string::npos ? SHT_DYNSYM : SHT_SYMTAB;
+  if (!elf.readSymbols(preferred, index)) {
+    elf.readSymbols(preferred == SHT_DYNSYM ? SHT_SYMTAB : SHT_DYNSYM, index);
   }
+  elf.readPltEntries(index);
+  index.finalize();
 
-  std::string desc;
-  std::string type;
+  if (index.empty()) {
+    errConsole->error("Unable to resolve symbol names for binary {}", object_file);
+  }
+  return index;
+}
 
-  if (fgets(buffer, sizeof(buffer), output)) {
-    std::istringstream line(buffer);
-    line >> desc >> type;
-  } else {
-    console->debug("Output buffer is empty.");
+std::string getELFType(const std::string& object_file) {
+  ElfFile elf(object_file);
+  if (!elf.isValid()) {
+    errConsole->error("Unable to read ELF file {}", object_file);
+    return {};
+  }
+  // Same names as printed by readelf
+  switch (elf.getHeader().e_type) {
+    case ET_NONE:
+      return "NONE";
+    case ET_REL:
+      return "REL";
+    case ET_EXEC:
+      return "EXEC";
+    case ET_DYN:
+      return "DYN";
+    case ET_CORE:
+      return "CORE";
+    default:
+      return "UNKNOWN";
   }
-  return type;
 }
 
 SymbolSetList loadSymbolSets(const std::string& execFile) {
@@ -252,6 +556,94 @@ SymTableList loadAllSymTables(const std::string& execFile) {
   return symTables;
 }
 
+/**
+ * Loads the symbols of the given objects, which are independent and read in parallel
+ */
+std::vector<SymbolIndex> loadSymbolIndices(const std::vector<MemMapEntry>& objects) {
+  std::vector<SymbolIndex> tables(objects.size());
+  std::atomic<std::size_t> nextEntry{0};
+  const auto worker = [&]() {
+    for (auto i = nextEntry++; i < objects.size(); i = nextEntry++) {
+      tables[i] = loadSymbolIndex(objects[i].path);
+    }
+  };
+  const auto numThreads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), objects.size());
+  if (numThreads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numThreads; ++t) {
+      threads.emplace_back(worker);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+  return tables;
+}
+
+/**
+ * The executable segments of all loaded objects, as reported by the dynamic linker. Addresses within an object are
+ * relative to its load address, so the offset of a segment is its virtual address in the object.
+ */
+std::vector<MemMapEntry> readLoadedObjects() {
+  struct Collector {
+    std::vector<MemMapEntry> entries;
+    std::string execPath;
+  } collector{{}, getExecPath()};
+  dl_iterate_phdr(
+      [](struct dl_phdr_info* info, size_t, void* data) {
+        auto& collector = *static_cast<Collector*>(data);
+        // The vDSO is not backed by a file
+        if (info->dlpi_addr == getauxval(AT_SYSINFO_EHDR)) {
+          return 0;
+        }
+        // The executable has an empty name, objects opened by a relative path keep it
+        std::string path = collector.execPath;
+        if (info->dlpi_name && info->dlpi_name[0] != '\0') {
+          char resolved[PATH_MAX];
+          path = realpath(info->dlpi_name, resolved) ? resolved : info->dlpi_name;
+        }
+        for (unsigned i = 0; i < info->dlpi_phnum; ++i) {
+          const auto& phdr = info->dlpi_phdr[i];
+          if (phdr.p_type == PT_LOAD && (phdr.p_flags & PF_X)) {
+            collector.entries.push_back({path, info->dlpi_addr + phdr.p_vaddr, phdr.p_vaddr});
+          }
+        }
+        return 0;
+      },
+      &collector);
+  return collector.entries;
+}
+
+std::size_t updateMappedSymTables(MappedSymTableMap& mappedSymTables) {
+  auto loaded = readLoadedObjects();
+
+  // Objects that are no longer loaded, or another object is loaded at their address now
+  for (auto it = mappedSymTables.begin(); it != mappedSymTables.end();) {
+    const auto stillLoaded = std::any_of(loaded.begin(), loaded.end(), [&](const MemMapEntry& entry) {
+      return entry.addrBegin == it->first && entry.path == it->second.memMap.path &&
+             entry.offset == it->second.memMap.offset;
+    });
+    it = stillLoaded ? std::next(it) : mappedSymTables.erase(it);
+  }
+
+  loaded.erase(std::remove_if(loaded.begin(), loaded.end(),
+                              [&](const MemMapEntry& entry) { return mappedSymTables.count(entry.addrBegin) != 0; }),
+               loaded.end());
+  auto tables = loadSymbolIndices(loaded);
+  std::size_t numAdded = 0;
+  for (std::size_t i = 0; i < loaded.size(); ++i) {
+    if (tables[i].empty()) {
+      console->error("Could not load symbols from {}", loaded[i].path);
+      continue;
+    }
+    mappedSymTables[loaded[i].addrBegin] = MappedSymTable{std::move(tables[i]), std::move(loaded[i])};
+    ++numAdded;
+  }
+  return numAdded;
+}
+
 MappedSymTableMap loadMappedSymTables(const std::string& execFile, bool printDebug) {
   MappedSymTableMap addrToSymTable;
 
@@ -262,9 +654,12 @@ MappedSymTableMap loadMappedSymTables(const std::string& execFile, bool printDeb
 
   // Load symbols from executable and shared libs
   auto memMap = readMemoryMap();
-  for (auto& entry : memMap) {
+  auto tables = loadSymbolIndices(memMap);
+
+  for (std::size_t i = 0; i < memMap.size(); ++i) {
+    auto& entry = memMap[i];
     auto& filename = entry.path;
-    auto table = loadSymbolTable(filename);
+    auto& table = tables[i];
     if (table.empty()) {
       console->error("Could not load symbols from {}", filename);
       continue;
@@ -276,7 +671,7 @@ MappedSymTableMap loadMappedSymTables(const std::string& execFile, bool printDeb
       console->debug(" > Offset: 0x{}{}", entry.offset, std::dec);
     }
     MappedSymTable mappedTable{std::move(table), entry};
-    addrToSymTable[entry.addrBegin] = mappedTable;
+    addrToSymTable[entry.addrBegin] = std::move(mappedTable);
   }
   return addrToSymTable;
 }
@@ -289,10 +684,6 @@ std::string findSymbol(uint64_t addrInProc, MappedSymTableMap& mappedSymTables)
   nextHighestIt--;
   const auto& symbolTable = nextHighestIt->second;
   auto addrInObj = mapAddrToObj(addrInProc, symbolTable);
-  auto it = symbolTable.table.find(addrInObj);
-  if (it != symbolTable.table.end()) {
-    return it->second;
-  }
-  return "";
+  return std::string(symbolTable.symbols.find(addrInObj));
 }
 }  // namespace SymbolRetriever
@@ -20,9 +20,9 @@ void caller(int x) {
 }
 
 // CHECK: define linkonce_odr dso_local void @_Z3fooIFvvEEvRT_(
-// CHECK: call void @__metacg_indirect_call
+// CHECK: call void @__metacg_indirect_call_site
 
 // CHECK: define linkonce_odr dso_local void @_Z12foo_with_argIFviEEvRT_i(
-// CHECK: call void @__metacg_indirect_call
+// CHECK: call void @__metacg_indirect_call_site
 
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: declare void @__metacg_indirect_call_site(
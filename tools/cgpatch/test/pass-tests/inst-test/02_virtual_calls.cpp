@@ -31,6 +31,6 @@ void caller() {
   delete b_pointer;
 }
 
-// CHECK-NOT: call void @__metacg_indirect_call
+// CHECK-NOT: call void @__metacg_indirect_call_site
 
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: declare void @__metacg_indirect_call_site(
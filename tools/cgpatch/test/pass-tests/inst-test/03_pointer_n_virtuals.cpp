@@ -21,11 +21,11 @@ void caller() {
 }
 
 // CHECK: define linkonce_odr dso_local noundef i32 @_ZN1B12foo_with_argEPFiiEi(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
 // CHECK: call noundef i32 %
 
 // CHECK: define linkonce_odr dso_local noundef i32 @_ZN1A12foo_with_argEPFiiEi(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
 // CHECK: call noundef i32 %{{[0-9]+}}(
 
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: declare void @__metacg_indirect_call_site(
@@ -5,4 +5,4 @@ inline int inlined_add(int x, int y) { return x + y; }
 void caller() { inlined_add(96, 4); }
 
 // CHECK: define linkonce_odr dso_local noundef i32 @_Z11inlined_addii(
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: declare void @__metacg_indirect_call_site(
@@ -24,7 +24,7 @@ void caller() {
 }
 
 // CHECK: define dso_local noundef i32 @_Z12bar_with_argPFiPviES_(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
 // CHECK: call noundef i32 %{{[0-9]+}}(
 
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: declare void @__metacg_indirect_call_site(
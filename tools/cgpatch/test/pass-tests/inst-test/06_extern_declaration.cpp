@@ -26,6 +26,6 @@ void bar(void) {
 }
 
 // CHECK: define dso_local void @_Z21test_function_pointerv(
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: declare void @__metacg_indirect_call_site(
@@ -22,5 +22,5 @@ void test_function_pointer(void) {
 }
 
 // CHECK: define dso_local void @_Z21test_function_pointerv
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
@@ -27,7 +27,7 @@ int main() {
 }
 
 // CHECK: define dso_local noundef i32 @main()
-// CHECK: call void @__metacg_indirect_call
-// CHECK: call void @__metacg_indirect_call
-// NOT: call void @__metacg_indirect_call
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site
+// CHECK: call void @__metacg_indirect_call_site
+// NOT: call void @__metacg_indirect_call_site
+// CHECK: declare void @__metacg_indirect_call_site(
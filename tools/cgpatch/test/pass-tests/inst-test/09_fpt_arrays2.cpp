@@ -23,6 +23,6 @@ void test_dynamic_function_pointers(void) {
 }
 
 // CHECK: define dso_local void @_Z30test_dynamic_function_pointersv()
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: declare void @__metacg_indirect_call_site(
@@ -19,6 +19,6 @@ void test_return_function_pointer(void) {
 }
 
 // CHECK: define dso_local void @_Z28test_return_function_pointerv()
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: declare void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: declare void @__metacg_indirect_call_site(
@@ -37,6 +37,6 @@ int main() {
   return 0;
 }
 // CHECK: define dso_local void @_Z28test_return_function_pointerv()
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
 // CHECK: declare void @__metacg
@@ -60,6 +60,6 @@ void test_complex_function_pointer(void) {
 }
 
 // CHECK: define dso_local void @_Z29test_complex_function_pointerv()
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
-// CHECK: call void @__metacg_indirect_call(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
+// CHECK: call void @__metacg_indirect_call_site(
@@ -0,0 +1,21 @@
+// RUN: %cgpatchcxx clang++ %s -emit-llvm -S -o - | %filecheck %s
+
+void bar() {}
+
+void caller(void (*f)()) {
+  f();
+  f();
+}
+
+int main() { caller(bar); }
+
+// CHECK: @__metacg_callsite_base = internal global i32 0
+// CHECK: @__metacg_callsites = private constant [2 x { ptr, ptr, i32, i32, i32 }] {{.*}} section "metacg_callsites"
+// CHECK: @llvm.global_ctors = appending global {{.*}} @__metacg_register_module_call_sites
+
+// CHECK: define dso_local void @_Z6callerPFvvE(
+// CHECK: load i32, ptr @__metacg_callsite_base
+// CHECK: call void @__metacg_indirect_call_site(i32
+
+// CHECK: define internal void @__metacg_register_module_call_sites()
+// CHECK: call void @__metacg_register_call_sites(ptr @__metacg_callsites, i32 2, ptr @__metacg_callsite_base, ptr @__metacg_callsite_cache)
@@ -0,0 +1,18 @@
+// RUN: %cgpatchcxx clang++ %s -emit-llvm -S -o - | %filecheck %s
+
+void bar() {}
+
+void caller(void (*f)()) { f(); }
+
+int main() { caller(bar); }
+
+// CHECK: @__metacg_callsite_cache = internal global [1 x [2 x ptr]] zeroinitializer, align 16
+
+// CHECK: define dso_local void @_Z6callerPFvvE(
+// CHECK: load atomic ptr, ptr @__metacg_callsite_cache unordered
+// CHECK: load atomic ptr, ptr getelementptr inbounds (ptr, ptr @__metacg_callsite_cache, i{{32|64}} 1) unordered
+// CHECK: br i1 {{%[0-9]+}}, label %[[MISS:[0-9]+]], label %[[CALL:[0-9]+]]
+// CHECK: [[MISS]]:
+// CHECK: call void @__metacg_indirect_call_site(i32 {{%[0-9]+}}, ptr {{%[0-9]+}}, ptr @__metacg_callsite_cache)
+// CHECK: [[CALL]]:
+// CHECK: call void {{%[0-9]+}}()
@@ -0,0 +1,27 @@
+// RUN: %cgpatchcxx --instrument-virtual-calls clang++ %s -emit-llvm -S -o - | %filecheck %s
+// RUN: %cgpatchcxx clang++ %s -emit-llvm -S -o - | %filecheck %s --check-prefix=DEFAULT
+
+struct A {
+  virtual int foo() { return 1; }
+};
+
+struct B : public A {
+  int foo() override { return 2; }
+};
+
+int caller(A* a) { return a->foo(); }
+
+int main() {
+  A a;
+  B b;
+  return caller(&a) + caller(&b);
+}
+
+// CHECK: define {{.*}} @_Z6callerP1A(
+// CHECK: call void @__metacg_indirect_call_site(i32 {{%[0-9]+}}, ptr [[TARGET:%[0-9]+]], ptr @__metacg_callsite_cache)
+// CHECK: call {{.*}} [[TARGET]](ptr
+
+// Virtual calls are not instrumented without the option
+// DEFAULT: define {{.*}} @_Z6callerP1A(
+// DEFAULT-NOT: @__metacg_indirect_call_site
+// DEFAULT: ret i32